@@ -1,7 +1,9 @@
 #include <benchmark/benchmark.h>
 
 #include <bloom_filter.hpp>
+#include <small_page_filter.hpp>
 
+#include <memory>
 #include <random>
 
 static constexpr size_t kCapacity = 1024;
@@ -24,7 +26,93 @@ static void BloomFilter_Test(benchmark::State& state) {
 }
 BENCHMARK(BloomFilter_Test);
 
+static void BlockedBloomFilter_Add(benchmark::State& state) {
+  cache::BlockedBloomFilter<kCapacity> bf;
+  std::mt19937 rng;
+  for (auto _ : state) {
+    bf.Add(rng());
+  }
+}
+BENCHMARK(BlockedBloomFilter_Add);
+
+static void BlockedBloomFilter_Test(benchmark::State& state) {
+  cache::BlockedBloomFilter<kCapacity> bf;
+  std::mt19937 rng;
+  for (auto _ : state) {
+    bf.Test(rng());
+  }
+}
+BENCHMARK(BlockedBloomFilter_Test);
+
+// a filter much larger than the caches: a probe is a cache miss
+static constexpr size_t kLargeCapacity = 1 << 24;
+
+static void BloomFilter_TestLarge(benchmark::State& state) {
+  auto bf = std::make_unique<cache::BloomFilter<kLargeCapacity>>();
+  std::mt19937 rng;
+  for (size_t i = 0; i < kLargeCapacity / 4; ++i) bf->Add(rng());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bf->Test(rng()));
+  }
+}
+BENCHMARK(BloomFilter_TestLarge);
+
+static void BlockedBloomFilter_TestLarge(benchmark::State& state) {
+  auto bf = std::make_unique<cache::BlockedBloomFilter<kLargeCapacity>>();
+  std::mt19937 rng;
+  for (size_t i = 0; i < kLargeCapacity / 4; ++i) bf->Add(rng());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bf->Test(rng()));
+  }
+}
+BENCHMARK(BlockedBloomFilter_TestLarge);
+
+// A guarded miss of a full small page: compare with the scan of the page in
+// small_page_find_benchmark.cpp
+static void SmallPageBloomFilter_Miss(benchmark::State& state) {
+  cache::SmallPageBloomFilter<cache::Key, true> filter;
+  for (size_t i = 0; i < cache::SMALL_PAGE_SIZE; ++i) {
+    filter.Add(static_cast<cache::Key>(i * cache::SMALL_PAGE_NUMBER));
+  }
+  cache::Key key = cache::SMALL_PAGE_SIZE * cache::SMALL_PAGE_NUMBER;
+  size_t false_positives = 0;
+  for (auto _ : state) {
+    false_positives += filter.MayContain(key);
+    key += cache::SMALL_PAGE_NUMBER;
+  }
+  state.counters["false_positive_rate"] =
+      static_cast<double>(false_positives) / state.iterations();
+}
+BENCHMARK(SmallPageBloomFilter_Miss);
+
 /*
+The blocked filter tests a key with a single AVX2 compare of one 256-bit
+block: ~2x faster once the filter doesn't fit the caches. It mixes the key
+first, so it's not faster on a filter in L1. The guard of a small page (a
+blocked filter since then) answers a miss ~10x faster than the AVX-512 scan of
+its 1024 keys (~50 ns):
+
+2026-10-17T01:10:37+00:00
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+--------------------------------------------------------------------
+Benchmark                          Time             CPU   Iterations
+--------------------------------------------------------------------
+BloomFilter_Add                    10.8 ns         10.6 ns     65677426
+BloomFilter_Test                   11.2 ns         11.0 ns     63724065
+BlockedBloomFilter_Add             15.6 ns         15.5 ns     44622841
+BlockedBloomFilter_Test            10.4 ns         10.3 ns     67533644
+BloomFilter_TestLarge              97.5 ns         92.4 ns      7398966
+BlockedBloomFilter_TestLarge       52.6 ns         49.9 ns     12634081
+SmallPageBloomFilter_Miss          5.82 ns         5.33 ns    116650713 false_positive_rate=1.26293m
+
+Before the blocked filter:
+SmallPageBloomFilter_Miss       24.3 ns         24.0 ns     36887786 false_positive_rate=555.116u
+
 Run on (16 X 4949.96 MHz CPU s)
 CPU Caches:
   L1 Data 32 KiB (x8)
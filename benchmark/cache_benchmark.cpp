@@ -0,0 +1,193 @@
+#include <benchmark/benchmark.h>
+
+#include <cache.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace {
+
+// more than LRU_SIZE, so most of the keys are looked up in the pages
+constexpr size_t kNumKeys = 1 << 17;
+
+constexpr size_t kLargePageKeys = 1ull
+                                  << (8 * sizeof(cache::Key) -
+                                      cache::LARGE_PAGE_SHIFT);
+
+// Keys of the initially loaded large pages, so no swaps happen
+std::vector<cache::Key> GenerateKeys(size_t num_keys) {
+  std::mt19937 rng;
+  std::vector<cache::Key> keys;
+  keys.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    const auto page = rng() % cache::LOADED_PAGE_NUMBER;
+    const auto offset = rng() % kLargePageKeys;
+    keys.push_back(static_cast<cache::Key>(page * kLargePageKeys + offset));
+  }
+  return keys;
+}
+
+std::unique_ptr<cache::Cache> MakeCache(const std::vector<cache::Key>& keys) {
+  std::filesystem::remove_all("/tmp/cache_benchmark");
+  auto cache = std::make_unique<cache::Cache>("/tmp/cache_benchmark");
+  const auto far_future = utils::Now() + 3600;
+  for (auto key : keys) cache->Update(key, far_future);
+  return cache;
+}
+
+}  // namespace
+
+static void Cache_Get(benchmark::State& state) {
+  const auto keys = GenerateKeys(state.range(0));
+  auto cache = MakeCache(keys);
+  const auto now = utils::Now();
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(cache->Get(key, now));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(Cache_Get)->Arg(kNumKeys);
+
+static void Cache_GetBatch(benchmark::State& state) {
+  const auto keys = GenerateKeys(state.range(0));
+  auto cache = MakeCache(keys);
+  const auto now = utils::Now();
+  std::vector<uint64_t> hits((keys.size() + 63) / 64);
+  for (auto _ : state) {
+    cache->GetBatch(keys, now, hits);
+    benchmark::DoNotOptimize(hits.data());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(Cache_GetBatch)->Arg(64)->Arg(kNumKeys);
+
+static void Cache_Update(benchmark::State& state) {
+  const auto keys = GenerateKeys(state.range(0));
+  auto cache = MakeCache({});
+  const auto far_future = utils::Now() + 3600;
+  for (auto _ : state) {
+    for (auto key : keys) cache->Update(key, far_future);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(Cache_Update)->Arg(kNumKeys);
+
+static void Cache_UpdateBatch(benchmark::State& state) {
+  const auto keys = GenerateKeys(state.range(0));
+  auto cache = MakeCache({});
+  const auto far_future = utils::Now() + 3600;
+  for (auto _ : state) {
+    cache->UpdateBatch(keys, far_future);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(Cache_UpdateBatch)->Arg(64)->Arg(kNumKeys);
+
+// Get, and Update on a miss, in phases of 2M accesses: skewed static keys
+// alternate with keys reused a few tens of thousands of accesses after their
+// first access. The keys of 2 large pages outnumber their slots, so the
+// pages evict. The argument is `CacheConfig::adaptive_lru`.
+static void Cache_GetUpdatePhases(benchmark::State& state) {
+  constexpr size_t kPhaseSize = 2'000'000;
+  constexpr size_t kPageKeys = 2 * kLargePageKeys;
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> dist;
+  std::exponential_distribution<double> age(1.0 / 60'000);
+  std::vector<cache::Key> keys;
+  keys.reserve(4 * kPhaseSize);
+  for (size_t i = 0; i < 4 * kPhaseSize; ++i) {
+    uint64_t id;
+    if ((i / kPhaseSize) % 2 == 0) {
+      id = static_cast<uint64_t>(1e8 * std::pow(dist(rng), 2.5));
+    } else {
+      id = (1ull << 40) + (i - std::min<size_t>(age(rng), i)) / 3;
+    }
+    keys.push_back(static_cast<cache::Key>(utils::Mix64(id) % kPageKeys));
+  }
+
+  std::filesystem::remove_all("/tmp/cache_benchmark");
+  cache::CacheConfig config;
+  config.adaptive_lru = state.range(0) != 0;
+  auto cache = std::make_unique<cache::Cache>("/tmp/cache_benchmark", config);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  size_t hits = 0;
+  for (auto _ : state) {
+    for (auto key : keys) {
+      if (cache->Get(key, now)) {
+        ++hits;
+      } else {
+        cache->Update(key, far_future);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  state.counters["hit_ratio"] =
+      static_cast<double>(hits) / (state.iterations() * keys.size());
+}
+BENCHMARK(Cache_GetUpdatePhases)->Arg(0)->Arg(1)->Iterations(2);
+
+/*
+A batch of up to 256 keys is grouped by a comparison sort, a larger one by a
+counting sort which visits only the offsets of its pages, instead of zeroing
+and summing the offsets of all the LARGE_PAGE_NUMBER pages on every call:
+
+2026-10-17T07:12:40+00:00
+Run on (1 X 2100 MHz CPU )
+Before:
+Cache_GetBatch/64_median             14160 ns        13068 ns            3 items_per_second=4.89742M/s
+Cache_GetBatch/131072_median      16994008 ns     15315672 ns            3 items_per_second=8.55803M/s
+Cache_UpdateBatch/64_median           7975 ns         7841 ns            3 items_per_second=8.16252M/s
+Cache_UpdateBatch/131072_median   54057529 ns     52499564 ns            3 items_per_second=2.49663M/s
+After:
+Cache_GetBatch/64_median              6716 ns         6637 ns            3 items_per_second=9.64261M/s
+Cache_GetBatch/131072_median      15839795 ns     15718874 ns            3 items_per_second=8.33851M/s
+Cache_UpdateBatch/64_median            914 ns          896 ns            3 items_per_second=71.4094M/s
+Cache_UpdateBatch/131072_median   49537952 ns     46744670 ns            3 items_per_second=2.804M/s
+
+ADAPTIVE_LRU = true climbs the LRU size within [LRU_SIZE / 4, 4 * LRU_SIZE]:
+the LRU grows in the phases of the recent keys and gives its entries back to
+the pages in the phases of the frequent ones. main.cpp hits 18.02% of a trace
+of 10M accesses over 40M ids instead of 14.87%, 52.17% of a skewed trace of
+20M accesses within the loaded pages instead of 51.44%, and 62.13% of that
+trace alternating with the recent keys every 2M accesses instead of 60.64%.
+The sampling costs nothing measurable on Cache_Get and Cache_GetBatch.
+
+2026-10-17T06:31:08+00:00
+Run on (1 X 2100 MHz CPU )
+Cache_GetUpdatePhases/0/iterations:2 4113963476 ns   4056395958 ns            2 hit_ratio=0.655923 items_per_second=1.97219M/s
+Cache_GetUpdatePhases/1/iterations:2 4436737420 ns   4375420006 ns            2 hit_ratio=0.721899 items_per_second=1.8284M/s
+Before:
+Cache_Get/131072_median           30381307 ns     30093042 ns            3 items_per_second=4.35556M/s
+Cache_GetBatch/131072_median      14743061 ns     14439497 ns            3 items_per_second=9.07732M/s
+After:
+Cache_Get/131072_median           29561489 ns     29310525 ns            3 items_per_second=4.47184M/s
+Cache_GetBatch/131072_median      13096907 ns     12918098 ns            3 items_per_second=10.1464M/s
+
+The window TinyLFU admission (the LRU as the window, its victims admitted
+to a loaded page only if they beat the victim of the small page) was
+dropped. Every Get of the window counted once in the sketch, the updates
+not counted twice, Cache_GetUpdatePhases hit 70.42% of the keys with it and
+70.94% without it. Only a sketch of 1M counters (TLFU_SIZE = 1 << 20) gave
+72.85% vs 71.94%, main.cpp didn't change with either sketch.
+
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+-----------------------------------------------------------------------------------------------------
+Benchmark                                           Time             CPU   Iterations UserCounters...
+-----------------------------------------------------------------------------------------------------
+Cache_Get/131072                             31542779 ns     31254089 ns           23 items_per_second=4.19376M/s
+Cache_GetBatch/131072                        16985936 ns     16875877 ns           39 items_per_second=7.76683M/s
+Cache_Update/131072                          36850857 ns     36086725 ns           21 items_per_second=3.63214M/s
+Cache_UpdateBatch/131072                     46214345 ns     45186858 ns           17 items_per_second=2.90067M/s
+*/
@@ -1,22 +1,147 @@
 #include <benchmark/benchmark.h>
 
 #include <cm_sketch.hpp>
+#include <tiny_lfu_cms.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <memory>
 #include <random>
+#include <unordered_map>
+#include <vector>
 
 static constexpr size_t kNumCounters = 1024;
 
+namespace {
+
+// the sample of TinyLFU: the sketch is reset after as many additions
+constexpr size_t kSampleSize = 10 * kNumCounters;
+
+// Skewed popularity of `kSampleSize` accesses to 4 * kNumCounters keys. The
+// ids are allocated sequentially with the given stride: with the stride of
+// the number of counters they differ in the high bits only.
+std::vector<uint32_t> GenerateTrace(uint32_t stride) {
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> dist;
+  std::vector<uint32_t> trace;
+  trace.reserve(kSampleSize);
+  for (size_t i = 0; i < kSampleSize; ++i) {
+    const auto id = static_cast<uint32_t>(4 * kNumCounters *
+                                          std::pow(dist(rng), 3.0));
+    trace.push_back(id * stride);
+  }
+  return trace;
+}
+
+// The first `max_size` keys of the real trace in the `CMS_TRACE` file (the
+// format of the datasets of main.cpp), if any
+std::vector<uint32_t> ReadTrace(size_t max_size = kSampleSize) {
+  std::vector<uint32_t> trace;
+  const char* path = std::getenv("CMS_TRACE");
+  if (path == nullptr) return trace;
+  std::ifstream input(path);
+  for (uint32_t key; trace.size() < max_size && input >> key;) {
+    trace.push_back(key);
+  }
+  return trace;
+}
+
+// Mean error of the estimations of the keys of the trace: the distance to the
+// real count limited by `max_count` (the counter, unless the saturation of the
+// counters is an error)
+template <class TSketch>
+void MeasureAccuracy(benchmark::State& state,
+                     const std::vector<uint32_t>& trace,
+                     size_t max_count = 15) {
+  if (trace.empty()) {
+    state.SkipWithError("no trace, set CMS_TRACE");
+    return;
+  }
+
+  std::unordered_map<uint32_t, size_t> counts;
+  for (auto key : trace) ++counts[key];
+
+  double error = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    TSketch sketch;
+    state.ResumeTiming();
+    for (auto key : trace) sketch.Add(key);
+    state.PauseTiming();
+
+    error = 0;
+    for (auto [key, count] : counts) {
+      error += std::abs(static_cast<double>(sketch.Estimate(key)) -
+                        static_cast<double>(std::min(count, max_count)));
+    }
+    state.ResumeTiming();
+  }
+  state.counters["mean_error"] = error / counts.size();
+  state.counters["bytes"] = sizeof(TSketch);
+  state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+// Hit ratio of an LRU cache of `kNumCounters` keys admitting a new key only if
+// the sketch estimates it above the LRU victim, as W-TinyLFU does without the
+// window
+template <class TSketch>
+void MeasureHitRatio(benchmark::State& state,
+                     const std::vector<uint32_t>& trace) {
+  if (trace.empty()) {
+    state.SkipWithError("no trace, set CMS_TRACE");
+    return;
+  }
+
+  using TLFU = cache::TinyLFU<uint32_t, kSampleSize, kNumCounters,
+                              /*UseDoorKeeper=*/false, TSketch>;
+  size_t hits = 0;
+  for (auto _ : state) {
+    auto tiny_lfu = std::make_unique<TLFU>();
+    std::list<uint32_t> lru;
+    std::unordered_map<uint32_t, std::list<uint32_t>::iterator> index;
+    hits = 0;
+    for (auto key : trace) {
+      tiny_lfu->Add(key);
+      if (auto it = index.find(key); it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        ++hits;
+        continue;
+      }
+      if (lru.size() == kNumCounters) {
+        if (tiny_lfu->Estimate(key) <= tiny_lfu->Estimate(lru.back())) {
+          continue;
+        }
+        index.erase(lru.back());
+        lru.pop_back();
+      }
+      lru.push_front(key);
+      index.emplace(key, lru.begin());
+    }
+  }
+  state.counters["hit_ratio"] = static_cast<double>(hits) / trace.size();
+  state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+}  // namespace
+
+template <class THashing>
 static void CMS_Add(benchmark::State& state) {
-  cache::CountMinSketch<kNumCounters> sketch;
+  cache::CountMinSketch<kNumCounters, THashing> sketch;
   std::mt19937 rng;
   for (auto _ : state) {
     sketch.Add(rng());
   }
 }
-BENCHMARK(CMS_Add);
+BENCHMARK(CMS_Add<cache::CmsXorSeedHashing>);
+BENCHMARK(CMS_Add<cache::CmsMultiplyShiftHashing>);
 
+template <class THashing>
 static void CMS_Estimate(benchmark::State& state) {
-  cache::CountMinSketch<kNumCounters> sketch;
+  cache::CountMinSketch<kNumCounters, THashing> sketch;
   std::mt19937 rng;
   for (size_t i = 0; i < kNumCounters; i++) {
     sketch.Add(rng());
@@ -26,9 +151,209 @@ static void CMS_Estimate(benchmark::State& state) {
     sketch.Estimate(rng());
   }
 }
-BENCHMARK(CMS_Estimate);
+BENCHMARK(CMS_Estimate<cache::CmsXorSeedHashing>);
+BENCHMARK(CMS_Estimate<cache::CmsMultiplyShiftHashing>);
+
+// ids allocated one by one
+template <class THashing>
+static void CMS_Accuracy_Sequential(benchmark::State& state) {
+  MeasureAccuracy<cache::CountMinSketch<kNumCounters, THashing>>(state, GenerateTrace(/*stride=*/1));
+}
+BENCHMARK(CMS_Accuracy_Sequential<cache::CmsXorSeedHashing>);
+BENCHMARK(CMS_Accuracy_Sequential<cache::CmsMultiplyShiftHashing>);
+
+// ids differing in the high bits only
+template <class THashing>
+static void CMS_Accuracy_Strided(benchmark::State& state) {
+  MeasureAccuracy<cache::CountMinSketch<kNumCounters, THashing>>(state, GenerateTrace(/*stride=*/kNumCounters));
+}
+BENCHMARK(CMS_Accuracy_Strided<cache::CmsXorSeedHashing>);
+BENCHMARK(CMS_Accuracy_Strided<cache::CmsMultiplyShiftHashing>);
+
+template <class THashing>
+static void CMS_Accuracy_Trace(benchmark::State& state) {
+  MeasureAccuracy<cache::CountMinSketch<kNumCounters, THashing>>(state, ReadTrace());
+}
+BENCHMARK(CMS_Accuracy_Trace<cache::CmsXorSeedHashing>);
+BENCHMARK(CMS_Accuracy_Trace<cache::CmsMultiplyShiftHashing>);
+
+// The error of the estimations of the frequent keys, the narrow counters are
+// saturated by them
+template <size_t CounterBits>
+static void CMS_Accuracy_Width(benchmark::State& state) {
+  MeasureAccuracy<cache::CountMinSketch<
+      kNumCounters, cache::CmsMultiplyShiftHashing, CounterBits>>(
+      state, GenerateTrace(/*stride=*/1), /*max_count=*/UINT16_MAX);
+}
+BENCHMARK(CMS_Accuracy_Width<4>);
+BENCHMARK(CMS_Accuracy_Width<8>);
+BENCHMARK(CMS_Accuracy_Width<16>);
+
+template <size_t CounterBits>
+static void CMS_Accuracy_Width_Trace(benchmark::State& state) {
+  MeasureAccuracy<cache::CountMinSketch<
+      kNumCounters, cache::CmsMultiplyShiftHashing, CounterBits>>(
+      state, ReadTrace(), /*max_count=*/UINT16_MAX);
+}
+BENCHMARK(CMS_Accuracy_Width_Trace<4>);
+BENCHMARK(CMS_Accuracy_Width_Trace<8>);
+BENCHMARK(CMS_Accuracy_Width_Trace<16>);
+
+// The admission decided by every width on the first 1M keys of the trace
+template <size_t CounterBits>
+static void CMS_HitRatio_Width_Trace(benchmark::State& state) {
+  MeasureHitRatio<cache::CountMinSketch<
+      kNumCounters, cache::CmsMultiplyShiftHashing, CounterBits>>(
+      state, ReadTrace(/*max_size=*/1 << 20));
+}
+BENCHMARK(CMS_HitRatio_Width_Trace<4>);
+BENCHMARK(CMS_HitRatio_Width_Trace<8>);
+BENCHMARK(CMS_HitRatio_Width_Trace<16>);
+
+static void BlockedCMS_HitRatio_Trace(benchmark::State& state) {
+  MeasureHitRatio<cache::BlockedCountMinSketch<kNumCounters>>(
+      state, ReadTrace(/*max_size=*/1 << 20));
+}
+BENCHMARK(BlockedCMS_HitRatio_Trace);
+
+// The counters of a key are in a block: 32 times less counters to choose from
+static void BlockedCMS_Accuracy_Sequential(benchmark::State& state) {
+  MeasureAccuracy<cache::BlockedCountMinSketch<kNumCounters>>(
+      state, GenerateTrace(/*stride=*/1));
+}
+BENCHMARK(BlockedCMS_Accuracy_Sequential);
+
+static void BlockedCMS_Accuracy_Trace(benchmark::State& state) {
+  MeasureAccuracy<cache::BlockedCountMinSketch<kNumCounters>>(state,
+                                                              ReadTrace());
+}
+BENCHMARK(BlockedCMS_Accuracy_Trace);
+
+// Random keys of a sketch of 2^CountersShift counters: the large ones don't
+// fit into the caches
+template <template <uint32_t> class TSketch, uint32_t CountersShift>
+static void CMS_AddEstimate_Size(benchmark::State& state) {
+  constexpr uint32_t kCounters = 1u << CountersShift;
+  auto sketch = std::make_unique<TSketch<kCounters>>();
+  std::mt19937 rng;
+  std::vector<uint32_t> keys(1 << 16);
+  for (auto& key : keys) key = rng();
+
+  for (auto _ : state) {
+    for (auto key : keys) {
+      sketch->Add(key);
+      benchmark::DoNotOptimize(sketch->Estimate(key ^ 1));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+template <uint32_t NumCounters>
+using SeparateRowsSketch = cache::CountMinSketch<NumCounters>;
+BENCHMARK(CMS_AddEstimate_Size<SeparateRowsSketch, 10>);
+BENCHMARK(CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 10>);
+BENCHMARK(CMS_AddEstimate_Size<SeparateRowsSketch, 16>);
+BENCHMARK(CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 16>);
+BENCHMARK(CMS_AddEstimate_Size<SeparateRowsSketch, 22>);
+BENCHMARK(CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 22>);
+
+template <template <uint32_t> class TSketch>
+static void CMS_Reset(benchmark::State& state) {
+  auto sketch = std::make_unique<TSketch<(1u << 16)>>();
+  for (auto _ : state) {
+    sketch->Reset();
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK(CMS_Reset<SeparateRowsSketch>);
+BENCHMARK(CMS_Reset<cache::BlockedCountMinSketch>);
 
 /*
+The hit ratio of the admission alone (no window, no large pages) on the first
+1M keys of the trace of CMS_Accuracy_Trace: the wider counters tell apart the
+keys above 15 and win 3 points. The blocked sketch admits as the 4-bit rows.
+
+2026-10-17T03:29:41+00:00
+Run on (1 X 2100 MHz CPU )
+CMS_HitRatio_Width_Trace<4>    98508591 ns     97433096 ns            7 hit_ratio=0.191269 items_per_second=10.762M/s
+CMS_HitRatio_Width_Trace<8>    63224962 ns     62471010 ns           11 hit_ratio=0.22081 items_per_second=16.785M/s
+CMS_HitRatio_Width_Trace<16>   61572315 ns     59531142 ns           11 hit_ratio=0.218502 items_per_second=17.6139M/s
+BlockedCMS_HitRatio_Trace      63385693 ns     62430889 ns           11 hit_ratio=0.19098 items_per_second=16.7958M/s
+
+The wider counters don't saturate on the frequent keys, but the sample of 10
+additions per counter leaves few keys above 15: the error is dominated by the
+collisions, which the memory of the wider counters doesn't reduce. The hit
+ratio of SmallPage_GetUpdate didn't change beyond the noise of the seeds
+(0.52-0.54 for 4, 8 and 16 bits, with a sample of 10 and 100 additions per
+counter), neither did the one of main.cpp on a skewed trace of 10M keys.
+
+2026-10-17T03:58:10+00:00
+Run on (1 X 2100 MHz CPU )
+CMS_Accuracy_Width<4>                                       263293 ns       258841 ns         2614 bytes=2.064k items_per_second=39.5609M/s mean_error=3.09818
+CMS_Accuracy_Width<8>                                       197130 ns       194063 ns         3420 bytes=4.112k items_per_second=52.7663M/s mean_error=2.86476
+CMS_Accuracy_Width<16>                                      187763 ns       184835 ns         6602 bytes=8.208k items_per_second=55.4009M/s mean_error=2.61606
+CMS_Accuracy_Width_Trace<4>                                 261448 ns       257386 ns         2757 bytes=2.064k items_per_second=39.7847M/s mean_error=5.44495
+CMS_Accuracy_Width_Trace<8>                                 144111 ns       142605 ns         3524 bytes=4.112k items_per_second=71.8069M/s mean_error=5.42998
+CMS_Accuracy_Width_Trace<16>                                212997 ns       207510 ns         3881 bytes=8.208k items_per_second=49.3469M/s mean_error=5.41123
+
+The rows are halved 8 bytes (32 bytes with AVX2) at a time instead of byte by
+byte:
+
+2026-10-17T02:30:02+00:00
+Run on (1 X 2100 MHz CPU )
+Before:
+CMS_Reset<SeparateRowsSketch>               106494 ns        92227 ns         7293
+After:
+CMS_Reset<SeparateRowsSketch>                 4550 ns         4484 ns       153387
+
+The blocked sketch keeps the 4 counters of a key in a 64-byte block: the
+separate rows miss the cache 4 times once the sketch doesn't fit into it
+(2^22 counters is 8 MiB), the blocked one only once. Its AVX2 kernels update
+and read the whole block at once, and the reset is a vector shift:
+
+2026-10-17T02:05:40+00:00
+Run on (1 X 2100 MHz CPU )
+CMS_Accuracy_Sequential<cache::CmsMultiplyShiftHashing>     255581 ns       252927 ns         2663 items_per_second=40.486M/s mean_error=3.01008
+BlockedCMS_Accuracy_Sequential                               79196 ns        77621 ns         9414 items_per_second=131.923M/s mean_error=2.55267
+CMS_AddEstimate_Size<SeparateRowsSketch, 10>               1206699 ns      1191763 ns          636 items_per_second=54.9908M/s
+CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 10>     1003060 ns       986305 ns          675 items_per_second=66.446M/s
+CMS_AddEstimate_Size<SeparateRowsSketch, 16>               1485305 ns      1469176 ns          439 items_per_second=44.6073M/s
+CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 16>     1057390 ns      1045030 ns          721 items_per_second=62.7121M/s
+CMS_AddEstimate_Size<SeparateRowsSketch, 22>               5197585 ns      5144026 ns          118 items_per_second=12.7402M/s
+CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 22>     1857165 ns      1842291 ns          408 items_per_second=35.5731M/s
+CMS_Reset<SeparateRowsSketch>                                78084 ns        76787 ns        13657
+CMS_Reset<cache::BlockedCountMinSketch>                       3338 ns         3300 ns       213083
+
+With the scalar kernels of the blocked sketch (no AVX2):
+CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 10>    3186915 ns      1574215 ns          427 items_per_second=41.6309M/s
+CMS_AddEstimate_Size<cache::BlockedCountMinSketch, 22>    6503796 ns      3227296 ns          188 items_per_second=20.3068M/s
+
+The multiply-shift hashing halves the overestimation of sequential ids and
+stops the aliasing of the ids differing in the high bits only. The aliased
+keys are added faster only because their counters are saturated.
+CMS_Accuracy_Trace was run on a generated trace (3M keys, skewed, in the
+format of the datasets of main.cpp): CMS_TRACE=/tmp/trace.txt
+
+2026-10-17T01:31:12+00:00
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+---------------------------------------------------------------------------------------------------------------------
+Benchmark                                                        Time             CPU   Iterations UserCounters...
+---------------------------------------------------------------------------------------------------------------------
+CMS_Add<cache::CmsXorSeedHashing>                             19.3 ns         18.9 ns     41068564
+CMS_Add<cache::CmsMultiplyShiftHashing>                       23.9 ns         23.2 ns     30155418
+CMS_Estimate<cache::CmsXorSeedHashing>                        10.6 ns         10.5 ns     63361790
+CMS_Estimate<cache::CmsMultiplyShiftHashing>                  10.4 ns         10.1 ns     68387129
+CMS_Accuracy_Sequential<cache::CmsXorSeedHashing>           191344 ns       188974 ns         3668 items_per_second=54.1874M/s mean_error=5.68661
+CMS_Accuracy_Sequential<cache::CmsMultiplyShiftHashing>     272863 ns       270246 ns         2483 items_per_second=37.8914M/s mean_error=2.60826
+CMS_Accuracy_Strided<cache::CmsXorSeedHashing>               81407 ns        79471 ns         6891 items_per_second=128.852M/s mean_error=12.2324
+CMS_Accuracy_Strided<cache::CmsMultiplyShiftHashing>        321849 ns       298160 ns         2859 items_per_second=34.3439M/s mean_error=2.64077
+CMS_Accuracy_Trace<cache::CmsXorSeedHashing>                195946 ns       191048 ns         3652 items_per_second=53.599M/s mean_error=8.66824
+CMS_Accuracy_Trace<cache::CmsMultiplyShiftHashing>          282839 ns       259806 ns         2602 items_per_second=39.4141M/s mean_error=5.35024
+
 2025-03-05T18:49:54+03:00
 Running ./build_release/benchmark/cache_benchmark
 Run on (16 X 3374.88 MHz CPU s)
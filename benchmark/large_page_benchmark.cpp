@@ -14,6 +14,17 @@ static void LargePage_StoreLoad(benchmark::State& state) {
 }
 BENCHMARK(LargePage_StoreLoad);
 
+static void LargePage_MmapStoreLoad(benchmark::State& state) {
+  cache::TTinyLFU tiny_lfu;
+  cache::LargePage large_page{tiny_lfu};
+  cache::LargePageMmapStore store{"/tmp/large_page_mmap"};
+  for (auto _ : state) {
+    store.Store(/*page_index=*/0, large_page);
+    store.Load(/*page_index=*/0, large_page);
+  }
+}
+BENCHMARK(LargePage_MmapStoreLoad);
+
 /*
 Running ./build_release/benchmark/cache_benchmark
 Run on (16 X 5065.12 MHz CPU s)
@@ -28,3 +39,17 @@ Benchmark                    Time             CPU   Iterations
 --------------------------------------------------------------
 LargePage_StoreLoad     649488 ns       608708 ns         1250
 */
+
+/*
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+------------------------------------------------------------------
+Benchmark                        Time             CPU   Iterations
+------------------------------------------------------------------
+LargePage_StoreLoad        1395570 ns      1265336 ns          562
+LargePage_MmapStoreLoad     399291 ns       391926 ns         1708
+*/
@@ -0,0 +1,163 @@
+#include <benchmark/benchmark.h>
+
+#include <flat_lru.hpp>
+#include <lru.hpp>
+
+#include <malloc.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t kLruSize = static_cast<size_t>(cache::LRU_SIZE);
+
+// skewed keys, 4 times more distinct keys than the LRU holds. The ranks are
+// scrambled: `std::hash` is the identity, the hot keys must not get adjacent
+// buckets.
+std::vector<cache::Key> GenerateSkewedKeys() {
+  constexpr size_t kNumKeys = 1 << 18;
+  constexpr double kDistinctKeys = 4 * kLruSize;
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> dist;
+  std::vector<cache::Key> keys;
+  keys.reserve(kNumKeys);
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const auto rank =
+        static_cast<uint64_t>(kDistinctKeys * std::pow(dist(rng), 3.0));
+    keys.push_back(static_cast<cache::Key>(utils::Mix64(rank)));
+  }
+  return keys;
+}
+
+size_t HeapSize() {
+  const auto info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+}  // namespace
+
+using TLRU = cache::LRU<cache::Key>;
+using TFlatLRU = cache::FlatLRU<cache::Key>;
+using TSieve = cache::SieveCache<cache::Key>;
+
+// Construction and filling of an empty LRU, then its destruction
+template <class TLru>
+static void LRU_WarmUp(benchmark::State& state) {
+  const auto far_future = utils::Now() + 3600;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    const auto heap_size = HeapSize();
+    TLru lru(kLruSize);
+    for (cache::Key key = 0; key < kLruSize; ++key) {
+      lru.Update(key, far_future);
+    }
+    benchmark::DoNotOptimize(lru.Get(0, far_future));
+    bytes = HeapSize() - heap_size;
+  }
+  state.SetItemsProcessed(state.iterations() * kLruSize);
+  state.counters["bytes_per_key"] = static_cast<double>(bytes) / kLruSize;
+}
+BENCHMARK(LRU_WarmUp<TLRU>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(LRU_WarmUp<TFlatLRU>)->Unit(benchmark::kMicrosecond);
+BENCHMARK(LRU_WarmUp<TSieve>)->Unit(benchmark::kMicrosecond);
+
+// Get, and Update on a miss
+template <class TLru>
+static void LRU_GetUpdate(benchmark::State& state) {
+  const auto keys = GenerateSkewedKeys();
+  TLru lru(kLruSize);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  size_t hits = 0;
+  for (auto _ : state) {
+    for (auto key : keys) {
+      if (lru.Get(key, now)) {
+        ++hits;
+      } else {
+        lru.Update(key, far_future);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  state.counters["hit_ratio"] =
+      static_cast<double>(hits) / (state.iterations() * keys.size());
+}
+BENCHMARK(LRU_GetUpdate<TLRU>);
+BENCHMARK(LRU_GetUpdate<TFlatLRU>);
+BENCHMARK(LRU_GetUpdate<TSieve>);
+
+// Hits only, the keys of the full LRU are accessed uniformly
+template <class TLru>
+static void LRU_GetHit(benchmark::State& state) {
+  TLru lru(kLruSize);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (cache::Key key = 0; key < kLruSize; ++key) {
+    lru.Update(key, far_future);
+  }
+
+  std::mt19937 rng;
+  std::vector<cache::Key> keys(1 << 18);
+  for (auto& key : keys) key = rng() % kLruSize;
+
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(lru.Get(key, now));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(LRU_GetHit<TLRU>);
+BENCHMARK(LRU_GetHit<TFlatLRU>);
+BENCHMARK(LRU_GetHit<TSieve>);
+
+/*
+SieveCache is FlatLRU with SIEVE eviction: a hit sets a byte of the entry
+instead of relinking three nodes, and the skewed keys stay cached longer. As
+the front cache of Cache (FRONT_CACHE = kSieve, opt-in) main.cpp on a trace
+of 10M accesses over 40M ids hits 14.87% of the keys instead of 9.46%, with
+188 ns per operation instead of 230 ns.
+
+2026-10-17T05:02:47+00:00
+Run on (1 X 2100 MHz CPU )
+LRU_WarmUp<TLRU>_median               514 us          510 us            3 bytes_per_key=40.0006 items_per_second=97.973M/s
+LRU_WarmUp<TFlatLRU>_median           883 us          868 us            3 bytes_per_key=33.0013 items_per_second=57.5878M/s
+LRU_WarmUp<TSieve>_median             964 us          934 us            3 bytes_per_key=34.0016 items_per_second=53.5613M/s
+LRU_GetUpdate<TLRU>_median       15355423 ns     15158566 ns            3 hit_ratio=0.511338 items_per_second=17.2935M/s
+LRU_GetUpdate<TFlatLRU>_median   17152043 ns     16879141 ns            3 hit_ratio=0.511245 items_per_second=15.5306M/s
+LRU_GetUpdate<TSieve>_median     13822775 ns     13631213 ns            3 hit_ratio=0.631584 items_per_second=19.2312M/s
+LRU_GetHit<TLRU>_median           5137888 ns      5058146 ns            3 items_per_second=51.8261M/s
+LRU_GetHit<TFlatLRU>_median       2988167 ns      2950071 ns            3 items_per_second=88.8602M/s
+LRU_GetHit<TSieve>_median         2323163 ns      2297653 ns            3 items_per_second=114.092M/s
+
+FlatLRU finds a key in adjacent slots of its table and links the nodes by
+32-bit indices: a hit is ~1.8 times faster, an entry takes 33 bytes instead
+of 40, and a miss with an eviction costs about the same. Its warm-up
+initializes all the arrays up front. Cache_Get and Cache_Update don't change
+beyond the noise, they are dominated by the pages, so FRONT_CACHE stays kLRU.
+
+2026-10-17T04:41:09+00:00
+Run on (1 X 2100 MHz CPU )
+LRU_WarmUp<TLRU>_median               509 us          506 us            3 bytes_per_key=40.0006 items_per_second=98.8434M/s
+LRU_WarmUp<TFlatLRU>_median          1027 us          998 us            3 bytes_per_key=33.0013 items_per_second=50.098M/s
+LRU_GetUpdate<TLRU>_median       16824424 ns     16567038 ns            3 hit_ratio=0.511191 items_per_second=15.8232M/s
+LRU_GetUpdate<TFlatLRU>_median   17162284 ns     17084728 ns            3 hit_ratio=0.511219 items_per_second=15.3438M/s
+LRU_GetHit<TLRU>_median           4531666 ns      4504723 ns            3 items_per_second=58.1931M/s
+LRU_GetHit<TFlatLRU>_median       2604520 ns      2554468 ns            3 items_per_second=102.622M/s
+
+The nodes are constructed in a single preallocated array instead of a malloc
+per node, the warm-up of LRU_SIZE keys is ~4.5 times faster and the steady
+state is unchanged:
+
+2026-10-17T04:12:31+00:00
+Run on (1 X 2100 MHz CPU )
+Before:
+LRU_WarmUp_median          2663 us         2645 us            3 items_per_second=18.9032M/s
+LRU_GetUpdate_median   12834655 ns     12627992 ns            3 hit_ratio=0.511467 items_per_second=20.759M/s
+After:
+LRU_WarmUp_median           579 us          553 us            3 items_per_second=90.4888M/s
+LRU_GetUpdate_median   12395365 ns     12021657 ns            3 hit_ratio=0.511567 items_per_second=21.806M/s
+*/
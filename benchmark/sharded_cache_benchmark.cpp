@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <sharded_cache.hpp>
+
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+
+const int kMaxThreads =
+    static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
+
+// Keys of the initially loaded large pages, so no swaps happen
+cache::Key GenerateKey(std::mt19937& rng) {
+  const auto page = rng() % cache::LOADED_PAGE_NUMBER;
+  return static_cast<cache::Key>(
+             page << (8 * sizeof(cache::Key) - cache::LARGE_PAGE_SHIFT)) +
+         rng() % 200'000;
+}
+
+template <class TCache>
+void GetOrUpdate(TCache& cache, cache::Key key, uint32_t now) {
+  if (!cache.Get(key, now)) cache.Update(key, now + 3600);
+}
+
+// `Cache` with a global lock, the baseline for the sharded one
+class LockedCache {
+ public:
+  explicit LockedCache(std::filesystem::path dir_path)
+      : cache_(std::move(dir_path)) {}
+
+  bool Get(cache::Key key, uint32_t now) {
+    std::lock_guard lock(mutex_);
+    return cache_.Get(key, now);
+  }
+
+  void Update(cache::Key key, uint32_t expiration_time) {
+    std::lock_guard lock(mutex_);
+    cache_.Update(key, expiration_time);
+  }
+
+ private:
+  std::mutex mutex_;
+  cache::Cache cache_;
+};
+
+}  // namespace
+
+static void Cache_GlobalLock(benchmark::State& state) {
+  static std::unique_ptr<LockedCache> cache;
+  if (state.thread_index() == 0) {
+    std::filesystem::remove_all("/tmp/locked_cache_benchmark");
+    cache = std::make_unique<LockedCache>("/tmp/locked_cache_benchmark");
+  }
+
+  std::mt19937 rng(state.thread_index());
+  const auto now = utils::Now();
+  for (auto _ : state) {
+    GetOrUpdate(*cache, GenerateKey(rng), now);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) cache.reset();
+}
+BENCHMARK(Cache_GlobalLock)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+static void ShardedCache_GetUpdate(benchmark::State& state) {
+  static std::unique_ptr<cache::ShardedCache> cache;
+  if (state.thread_index() == 0) {
+    std::filesystem::remove_all("/tmp/sharded_cache_benchmark");
+    cache = std::make_unique<cache::ShardedCache>(
+        cache::ShardedCache::kDefaultShardsNumber,
+        "/tmp/sharded_cache_benchmark");
+  }
+
+  std::mt19937 rng(state.thread_index());
+  const auto now = utils::Now();
+  for (auto _ : state) {
+    GetOrUpdate(*cache, GenerateKey(rng), now);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) cache.reset();
+}
+BENCHMARK(ShardedCache_GetUpdate)->ThreadRange(1, kMaxThreads)->UseRealTime();
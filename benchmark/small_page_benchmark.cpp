@@ -0,0 +1,191 @@
+#include <benchmark/benchmark.h>
+
+#include <small_page.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// skewed keys, 4 times more distinct keys than the page holds
+std::vector<cache::Key> GenerateSkewedKeys() {
+  constexpr size_t kNumKeys = 1 << 16;
+  constexpr double kDistinctKeys = 4 * cache::SMALL_PAGE_SIZE;
+  std::mt19937 rng;
+  std::uniform_real_distribution<double> dist;
+  std::vector<cache::Key> keys;
+  keys.reserve(kNumKeys);
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    keys.push_back(
+        static_cast<cache::Key>(kDistinctKeys * std::pow(dist(rng), 3.0)));
+  }
+  return keys;
+}
+
+}  // namespace
+
+// Get, and Update on a miss
+template <cache::SmallPageOrdering Ordering>
+static void SmallPage_GetUpdate(benchmark::State& state) {
+  const auto keys = GenerateSkewedKeys();
+  cache::TTinyLFU tiny_lfu;
+  auto small_page =
+      std::make_unique<cache::BasicSmallPage<cache::Key, cache::NoValues,
+                                             Ordering>>(tiny_lfu);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  size_t hits = 0;
+  for (auto _ : state) {
+    for (auto key : keys) {
+      if (small_page->Get(key, now)) {
+        ++hits;
+      } else {
+        small_page->Update(key, far_future);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+  state.counters["hit_ratio"] =
+      static_cast<double>(hits) / (state.iterations() * keys.size());
+}
+BENCHMARK(SmallPage_GetUpdate<cache::SmallPageOrdering::kRaise>);
+BENCHMARK(SmallPage_GetUpdate<cache::SmallPageOrdering::kSampledVictim>);
+BENCHMARK(SmallPage_GetUpdate<cache::SmallPageOrdering::kHashed>);
+
+// Hits only, the keys of the full page are accessed uniformly
+template <cache::SmallPageOrdering Ordering>
+static void SmallPage_GetHit(benchmark::State& state) {
+  cache::TTinyLFU tiny_lfu;
+  auto small_page =
+      std::make_unique<cache::BasicSmallPage<cache::Key, cache::NoValues,
+                                             Ordering>>(tiny_lfu);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (cache::Key key = 0; key < cache::SMALL_PAGE_SIZE; ++key) {
+    small_page->Update(key, far_future);
+  }
+
+  std::mt19937 rng;
+  std::vector<cache::Key> keys(1 << 16);
+  for (auto& key : keys) key = rng() % cache::SMALL_PAGE_SIZE;
+
+  for (auto _ : state) {
+    for (auto key : keys) {
+      benchmark::DoNotOptimize(small_page->Get(key, now));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(SmallPage_GetHit<cache::SmallPageOrdering::kRaise>);
+BENCHMARK(SmallPage_GetHit<cache::SmallPageOrdering::kSampledVictim>);
+BENCHMARK(SmallPage_GetHit<cache::SmallPageOrdering::kHashed>);
+
+// The latency of a hit: a buffered one is a search and a store, the one
+// draining the buffer applies all of them
+template <cache::SmallPageOrdering Ordering>
+static void SmallPage_GetHitLatency(benchmark::State& state) {
+  cache::TTinyLFU tiny_lfu;
+  auto small_page =
+      std::make_unique<cache::BasicSmallPage<cache::Key, cache::NoValues,
+                                             Ordering>>(tiny_lfu);
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (cache::Key key = 0; key < cache::SMALL_PAGE_SIZE; ++key) {
+    small_page->Update(key, far_future);
+  }
+
+  const auto keys = GenerateSkewedKeys();
+  std::vector<uint32_t> latencies;
+  latencies.reserve(keys.size());
+  for (auto _ : state) {
+    latencies.clear();
+    for (auto key : keys) {
+      // the skewed keys beyond the page are misses
+      if (key >= cache::SMALL_PAGE_SIZE) continue;
+      const auto start = std::chrono::steady_clock::now();
+      benchmark::DoNotOptimize(small_page->Get(key, now));
+      const auto end = std::chrono::steady_clock::now();
+      latencies.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+              .count());
+    }
+  }
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p50_ns"] = latencies[latencies.size() / 2];
+  state.counters["p99_ns"] = latencies[latencies.size() * 99 / 100];
+}
+BENCHMARK(SmallPage_GetHitLatency<cache::SmallPageOrdering::kRaise>);
+BENCHMARK(SmallPage_GetHitLatency<cache::SmallPageOrdering::kSampledVictim>);
+BENCHMARK(SmallPage_GetHitLatency<cache::SmallPageOrdering::kHashed>);
+
+/*
+The hits are buffered (SMALL_PAGE_READ_BUFFER_SIZE = 16): the median hit only
+searches the key and stores its slot, the draining one applies the sketch
+updates and the raises of the batch. The throughput is about the same, a kRaise
+hit finds the keys whose raises are buffered deeper.
+
+2026-10-17T03:20:44+00:00
+Run on (1 X 2100 MHz CPU )
+SMALL_PAGE_READ_BUFFER_SIZE = 0:
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kRaise>            8555548 ns      8407588 ns           85 p50_ns=135 p99_ns=378
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kSampledVictim>    6649227 ns      6514858 ns          111 p50_ns=95 p99_ns=140
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kHashed>           5458730 ns      5347278 ns          131 p50_ns=72 p99_ns=140
+SMALL_PAGE_READ_BUFFER_SIZE = 16:
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kRaise>            8752445 ns      8563711 ns           86 p50_ns=66 p99_ns=1.666k
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kSampledVictim>    6213481 ns      6186921 ns          131 p50_ns=70 p99_ns=416
+SmallPage_GetHitLatency<cache::SmallPageOrdering::kHashed>           5126247 ns      5032658 ns          136 p50_ns=54 p99_ns=491
+
+kHashed reads a single bucket of 16 keys (a cache line) instead of scanning the
+page on a miss, with about the hit ratio of kSampledVictim:
+
+2026-10-17T00:31:05+00:00
+Running ./build_release/benchmark/cache_benchmark
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+------------------------------------------------------------------------------------------------------------------------
+Benchmark                                                              Time             CPU   Iterations UserCounters...
+------------------------------------------------------------------------------------------------------------------------
+SmallPage_GetUpdate<cache::SmallPageOrdering::kRaise>            7335481 ns      7236362 ns           91 hit_ratio=0.521682 items_per_second=9.05648M/s
+SmallPage_GetUpdate<cache::SmallPageOrdering::kSampledVictim>    3819459 ns      3786414 ns          157 hit_ratio=0.48008 items_per_second=17.3082M/s
+SmallPage_GetUpdate<cache::SmallPageOrdering::kHashed>           3200210 ns      3179089 ns          215 hit_ratio=0.487214 items_per_second=20.6147M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kRaise>              10379939 ns     10218153 ns           72 items_per_second=6.41368M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kSampledVictim>       4017516 ns      3987238 ns          169 items_per_second=16.4364M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kHashed>              1976415 ns      1909154 ns          410 items_per_second=34.3272M/s
+
+kRaise keeps the better hit ratio on a skewed workload with many misses,
+kSampledVictim makes the hits of a full page with flat frequencies faster.
+The frequencies cached alongside the records spare the sketch lookups of the
+records a key is compared with, so a kRaise hit costs a single estimation:
+
+Before caching the frequencies:
+SmallPage_GetUpdate<cache::SmallPageOrdering::kRaise>            6482296 ns      6155174 ns          107 hit_ratio=0.502272 items_per_second=10.6473M/s
+SmallPage_GetUpdate<cache::SmallPageOrdering::kSampledVictim>    8774177 ns      8430686 ns           89 hit_ratio=0.473289 items_per_second=7.77351M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kRaise>             125126348 ns    121803495 ns            6 items_per_second=538.047k/s
+SmallPage_GetHit<cache::SmallPageOrdering::kSampledVictim>       5302736 ns      5153566 ns          129 items_per_second=12.7166M/s
+
+After:
+2026-10-16T23:58:12+00:00
+Running ./build_release/benchmark/cache_benchmark
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+------------------------------------------------------------------------------------------------------------------------
+Benchmark                                                              Time             CPU   Iterations UserCounters...
+------------------------------------------------------------------------------------------------------------------------
+SmallPage_GetUpdate<cache::SmallPageOrdering::kRaise>            8547683 ns      8147247 ns           91 hit_ratio=0.521682 items_per_second=8.04394M/s
+SmallPage_GetUpdate<cache::SmallPageOrdering::kSampledVictim>    7007357 ns      6694190 ns          130 hit_ratio=0.480204 items_per_second=9.78998M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kRaise>              12003722 ns     11225042 ns           55 items_per_second=5.83837M/s
+SmallPage_GetHit<cache::SmallPageOrdering::kSampledVictim>       6365623 ns      6047301 ns          124 items_per_second=10.8372M/s
+*/
@@ -9,7 +9,7 @@
 namespace {
 
 struct Records {
-  alignas(32) std::array<cache::Key, cache::SMALL_PAGE_SIZE> data{};
+  alignas(64) std::array<cache::Key, cache::SMALL_PAGE_SIZE> data{};
 };
 
 std::pair<Records, uint32_t> getInitRecordsAndKeyToBeFind() {
@@ -41,6 +41,30 @@ std::pair<Records, uint32_t> getInitRecordsAndKeyToBeFind() {
   return {data_and_key.first, data_and_key.second};
 }
 
+struct Records64 {
+  alignas(64) std::array<uint64_t, cache::SMALL_PAGE_SIZE> data{};
+};
+
+// absent key, so the whole page is scanned as on a miss
+std::pair<Records64, uint64_t> getInitRecords64AndKeyToBeFind() {
+  static auto data_and_key = [&]() {
+    std::mt19937_64 gen{std::random_device{}()};
+    Records64 records{};
+    for (auto& record : records.data) {
+      record = gen() | 1;
+    }
+    return std::pair<Records64, uint64_t>{records, 0};
+  }();
+
+  return data_and_key;
+}
+
+bool IsSupported(cache::SimdLevel level, benchmark::State& state) {
+  if (level <= cache::kSimdLevel) return true;
+  state.SkipWithError("the instruction set isn't supported by the CPU");
+  return false;
+}
+
 }  // namespace
 
 static void SmallPage_SimpleFind(benchmark::State& state) {
@@ -70,7 +94,130 @@ static void SmallPage_SIMD_16(benchmark::State& state) {
 }
 BENCHMARK(SmallPage_SIMD_16);
 
+static void SmallPage_SSE42(benchmark::State& state) {
+  if (!IsSupported(cache::SimdLevel::kSSE42, state)) return;
+  const auto [records, key] = getInitRecordsAndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxSSE42(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_SSE42);
+
+static void SmallPage_AVX512(benchmark::State& state) {
+  if (!IsSupported(cache::SimdLevel::kAVX512, state)) return;
+  const auto [records, key] = getInitRecordsAndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxAVX512(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_AVX512);
+
+// the kernel picked at startup, called through a function pointer
+static void SmallPage_Dispatched(benchmark::State& state) {
+  const auto [records, key] = getInitRecordsAndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxDispatched(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_Dispatched);
+
+static void SmallPage_SimpleFind64(benchmark::State& state) {
+  const auto [records, key] = getInitRecords64AndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdx(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_SimpleFind64);
+
+static void SmallPage_SIMD_16_64(benchmark::State& state) {
+  const auto [records, key] = getInitRecords64AndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxSIMD16(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_SIMD_16_64);
+
+static void SmallPage_SSE42_64(benchmark::State& state) {
+  if (!IsSupported(cache::SimdLevel::kSSE42, state)) return;
+  const auto [records, key] = getInitRecords64AndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxSSE42(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_SSE42_64);
+
+static void SmallPage_AVX512_64(benchmark::State& state) {
+  if (!IsSupported(cache::SimdLevel::kAVX512, state)) return;
+  const auto [records, key] = getInitRecords64AndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxAVX512(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_AVX512_64);
+
+static void SmallPage_Dispatched64(benchmark::State& state) {
+  const auto [records, key] = getInitRecords64AndKeyToBeFind();
+  for (auto _ : state) {
+    auto res = cache::FindKeyIdxDispatched(key, records.data);
+    benchmark::DoNotOptimize(res);
+  }
+}
+BENCHMARK(SmallPage_Dispatched64);
+
 /*
+ALL THE KERNELS (a miss, the whole page is scanned), built without -mavx2:
+the vector kernels are compiled via the target attribute and the dispatched
+one is picked at startup (AVX-512 here):
+
+2026-10-17T00:12:40+00:00
+Running ./build_release/benchmark/cache_benchmark
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+-----------------------------------------------------------------
+Benchmark                       Time             CPU   Iterations
+-----------------------------------------------------------------
+SmallPage_SimpleFind          395 ns          389 ns      1518109
+SmallPage_SIMD_8              127 ns          121 ns      6486991
+SmallPage_SIMD_16             102 ns         99.8 ns      8045090
+SmallPage_SSE42               144 ns          140 ns      5187714
+SmallPage_AVX512             55.9 ns         50.2 ns     13550805
+SmallPage_Dispatched         51.7 ns         49.3 ns     13596004
+SmallPage_SimpleFind64        419 ns          415 ns      1495313
+SmallPage_SIMD_16_64          127 ns          123 ns      5404085
+SmallPage_SSE42_64            279 ns          250 ns      2907493
+SmallPage_AVX512_64           105 ns          103 ns      7565476
+SmallPage_Dispatched64        110 ns          108 ns      6902245
+
+64-BIT KEYS (a miss, the whole page of 8 KiB is scanned):
+
+2026-10-16T23:29:29+00:00
+Running ./build_release/benchmark/cache_benchmark
+Run on (1 X 2100 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 307200 KiB (x1)
+---------------------------------------------------------------
+Benchmark                     Time             CPU   Iterations
+---------------------------------------------------------------
+SmallPage_SimpleFind        340 ns          327 ns      2377573
+SmallPage_SIMD_8            122 ns          120 ns      7105745
+SmallPage_SIMD_16          57.1 ns         56.0 ns     11510134
+SmallPage_SimpleFind64      378 ns          372 ns      2239878
+SmallPage_SIMD_16_64       97.3 ns         96.0 ns      7381034
+
 DOUBLE SWAP:
 
 2025-04-04T10:25:44+03:00
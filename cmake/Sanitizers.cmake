@@ -3,3 +3,9 @@ if (ASAN_ENABLED)
     set(CMAKE_EXE_LINKER_FLAGS -fsanitize=address,undefined)
     message(STATUS "Address and Undefined sanitizers enabled")
 endif()
+
+if (TSAN_ENABLED)
+    add_compile_options(-fsanitize=thread)
+    set(CMAKE_EXE_LINKER_FLAGS -fsanitize=thread)
+    message(STATUS "Thread sanitizer enabled")
+endif()
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace cache {
+
+// Single-threaded FIFO job queue. Jobs are executed strictly in the order
+// they were pushed, so jobs touching the same resource need no extra
+// synchronization between each other. The thread is started on the first
+// `Push`, so an idle worker costs nothing.
+class BackgroundWorker final {
+ public:
+  using Job = std::function<void()>;
+
+  BackgroundWorker() = default;
+
+  BackgroundWorker(BackgroundWorker&&) = delete;
+  BackgroundWorker(const BackgroundWorker&) = delete;
+
+  BackgroundWorker& operator=(BackgroundWorker&&) = delete;
+  BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+  ~BackgroundWorker() {
+    {
+      std::lock_guard lock(mutex_);
+      stopped_ = true;
+    }
+    job_cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+  }
+
+  void Push(Job job) {
+    {
+      std::lock_guard lock(mutex_);
+      jobs_.push_back(std::move(job));
+      if (!thread_.joinable()) thread_ = std::thread([this] { Run(); });
+    }
+    job_cv_.notify_one();
+  }
+
+  // Blocks until every pushed job is finished
+  void Wait() {
+    std::unique_lock lock(mutex_);
+    idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+  }
+
+ private:
+  void Run() {
+    std::unique_lock lock(mutex_);
+    while (true) {
+      job_cv_.wait(lock, [this] { return stopped_ || !jobs_.empty(); });
+      // pending jobs are drained even on stop: they may carry dirty pages
+      if (jobs_.empty()) return;
+
+      auto job = std::move(jobs_.front());
+      jobs_.pop_front();
+      busy_ = true;
+
+      lock.unlock();
+      job();
+      lock.lock();
+
+      busy_ = false;
+      if (jobs_.empty()) idle_cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<Job> jobs_;
+  bool busy_{false};
+  bool stopped_{false};
+  std::thread thread_;
+};
+
+}  // namespace cache
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <bit>
 #include <cmath>
 #include <cstdint>
 #include <fstream>
 
+#include "simd.hpp"
 #include "utils.hpp"
 
 namespace cache {
@@ -29,6 +32,7 @@ class BloomFilter final {
   static constexpr auto kNumHashFunc =
       std::max(2U, static_cast<uint32_t>(0.7 * kNumBits / Capacity));
   static constexpr auto kDataSize = (kNumBits + 63) / 64;
+  static constexpr size_t kDataSizeInBytes = kDataSize * sizeof(uint64_t);
 
   bool Add(uint64_t key) noexcept {
     const auto h1 = static_cast<uint32_t>(key);
@@ -70,6 +74,14 @@ class BloomFilter final {
     utils::BinaryWrite(file, data_.data(), data_.size() * sizeof(data_[0]));
   }
 
+  void Load(const char* buffer) noexcept {
+    utils::LoadArrayFromBuffer(buffer, data_);
+  }
+
+  void Store(char* buffer) const noexcept {
+    utils::StoreArrayToBuffer(buffer, data_);
+  }
+
   bool operator==(const BloomFilter& other) const {
     return kNumBits == other.kNumBits && kNumHashFunc == other.kNumHashFunc &&
            data_ == other.data_;
@@ -79,4 +91,127 @@ class BloomFilter final {
   std::array<uint64_t, kDataSize> data_{};
 };
 
+namespace detail {
+
+// A block of the blocked filter: 8 words of 32 bits, a key sets a bit in every
+// word. The block fits an AVX2 register and never crosses a cache line.
+inline constexpr size_t kBlockWords = 8;
+inline constexpr std::array<uint32_t, kBlockWords> kBlockSalts = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+// Returns true if all the bits of the key were already set
+inline bool AddToBlock(uint32_t* block, uint32_t hash) noexcept {
+  bool was_added = true;
+  for (size_t i = 0; i < kBlockWords; ++i) {
+    const uint32_t mask = 1U << ((hash * kBlockSalts[i]) >> 27);
+    was_added &= (block[i] & mask) != 0;
+    block[i] |= mask;
+  }
+  return was_added;
+}
+
+inline bool TestBlock(const uint32_t* block, uint32_t hash) noexcept {
+  bool was_added = true;
+  for (size_t i = 0; i < kBlockWords; ++i) {
+    const uint32_t mask = 1U << ((hash * kBlockSalts[i]) >> 27);
+    was_added &= (block[i] & mask) != 0;
+  }
+  return was_added;
+}
+
+CACHE_TARGET("avx2")
+inline __m256i MakeBlockMaskAVX2(uint32_t hash) noexcept {
+  const auto salts = _mm256_loadu_si256(
+      reinterpret_cast<const __m256i*>(kBlockSalts.data()));
+  auto shifts =
+      _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(hash)), salts);
+  shifts = _mm256_srli_epi32(shifts, 27);
+  return _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+}
+
+CACHE_TARGET("avx2")
+inline bool AddToBlockAVX2(uint32_t* block, uint32_t hash) noexcept {
+  auto* data = reinterpret_cast<__m256i*>(block);
+  const auto mask = MakeBlockMaskAVX2(hash);
+  const auto bits = _mm256_load_si256(data);
+  const bool was_added = _mm256_testc_si256(bits, mask);
+  _mm256_store_si256(data, _mm256_or_si256(bits, mask));
+  return was_added;
+}
+
+CACHE_TARGET("avx2")
+inline bool TestBlockAVX2(const uint32_t* block, uint32_t hash) noexcept {
+  const auto bits = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+  return _mm256_testc_si256(bits, MakeBlockMaskAVX2(hash));
+}
+
+}  // namespace detail
+
+// Blocked Bloom filter: all the bits of a key are in a single block of 256
+// bits, so a test costs one cache miss instead of `kNumHashFunc` ones. The
+// keys are hashed by the filter itself. Slightly more false positives than
+// `BloomFilter` of the same size.
+template <size_t Capacity>
+class BlockedBloomFilter final {
+ public:
+  static constexpr auto kNumBits = detail::CalcNumBits(Capacity);
+  static constexpr size_t kNumBlocks = kNumBits / (32 * detail::kBlockWords);
+  static_assert(std::has_single_bit(kNumBlocks));
+  static constexpr size_t kDataSizeInBytes = kNumBits / 8;
+
+  // Returns true if the key was (probably) added before
+  bool Add(uint64_t key) noexcept {
+    const auto hash = utils::Mix64(key);
+    auto* block = GetBlock(hash);
+    if (kSimdLevel >= SimdLevel::kAVX2) {
+      return detail::AddToBlockAVX2(block, static_cast<uint32_t>(hash));
+    }
+    return detail::AddToBlock(block, static_cast<uint32_t>(hash));
+  }
+
+  bool Test(uint64_t key) const noexcept {
+    const auto hash = utils::Mix64(key);
+    const auto* block = GetBlock(hash);
+    if (kSimdLevel >= SimdLevel::kAVX2) {
+      return detail::TestBlockAVX2(block, static_cast<uint32_t>(hash));
+    }
+    return detail::TestBlock(block, static_cast<uint32_t>(hash));
+  }
+
+  void Clear() noexcept { data_.fill(0); }
+
+  void Load(std::ifstream& file) {
+    utils::BinaryRead(file, data_.data(), kDataSizeInBytes);
+  }
+
+  void Store(std::ofstream& file) const {
+    utils::BinaryWrite(file, data_.data(), kDataSizeInBytes);
+  }
+
+  void Load(const char* buffer) noexcept {
+    utils::LoadArrayFromBuffer(buffer, data_);
+  }
+
+  void Store(char* buffer) const noexcept {
+    utils::StoreArrayToBuffer(buffer, data_);
+  }
+
+  bool operator==(const BlockedBloomFilter& other) const noexcept {
+    return data_ == other.data_;
+  }
+
+ private:
+  // the high half of the hash picks the block, the low one the bits
+  uint32_t* GetBlock(uint64_t hash) noexcept {
+    return &data_[((hash >> 32) & (kNumBlocks - 1)) * detail::kBlockWords];
+  }
+
+  const uint32_t* GetBlock(uint64_t hash) const noexcept {
+    return &data_[((hash >> 32) & (kNumBlocks - 1)) * detail::kBlockWords];
+  }
+
+  alignas(32) std::array<uint32_t, kNumBlocks * detail::kBlockWords> data_{};
+};
+
 }  // namespace cache
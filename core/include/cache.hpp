@@ -1,62 +1,328 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <cache_config.hpp>
+#include <flat_lru.hpp>
+#include <hill_climber.hpp>
 #include <large_page_provider.hpp>
 #include <lru.hpp>
 
 namespace cache {
 
-class Cache {
+template <CacheKey TKey, class Value>
+using TFrontCache = std::conditional_t<
+    FRONT_CACHE == FrontCache::kLRU,
+    LRU<TKey, std::hash<TKey>, std::equal_to<TKey>, Value>,
+    BasicFlatCache<TKey, std::hash<TKey>, std::equal_to<TKey>, Value,
+                   FRONT_CACHE == FrontCache::kSieve ? FlatEviction::kSieve
+                                                     : FlatEviction::kLRU>>;
+
+// `TValues` is the storage of the values in the small pages (see
+// small_page_values.hpp), by default the cache keeps only the keys
+template <CacheKey TKey = Key, class TValues = NoValues>
+class BasicCache {
  public:
-  explicit Cache(std::filesystem::path dir_path = "./data")
+  using Value = typename TValues::Value;
+
+  // RAM of a loaded large page, see `CacheConfig::loaded_page_number`
+  static constexpr size_t kLargePageSizeInBytes =
+      sizeof(typename BasicLargePageProvider<TKey, TValues>::TLargePage);
+
+  explicit BasicCache(std::filesystem::path dir_path = "./data",
+                      const CacheConfig& config = {})
       : tiny_lfu_(),
-        provider_(std::move(dir_path), tiny_lfu_)
+        provider_(std::move(dir_path), tiny_lfu_, config)
 #if USE_LRU_FLAG
         ,
-        lru_(static_cast<size_t>(LRU_SIZE))
+        use_lru_(config.use_lru),
+        lru_(LruCapacity(ValidateLru(config)))
 #endif
   {
+#if USE_LRU_FLAG
+    if (use_lru_ && config.adaptive_lru) {
+      lru_.SetMaxSize(config.lru_size);
+      climber_.emplace(config.min_lru_size, config.max_lru_size,
+                       config.lru_size, config.lru_climb_period);
+    }
+#endif
   }
 
-  bool Get(Key key, uint32_t now) {
+  // `out` (if any) receives the value of the key on a hit
+  bool Get(TKey key, uint32_t now, Value* out = nullptr) {
 #if USE_LRU_FLAG
-    if (lru_.Get(key, now)) return true;
+    if (use_lru_ && lru_.Get(key, now, out)) {
+      OnAccess(true);
+      return true;
+    }
 #endif
 
-    auto* maybe_large_page = provider_.Get</*CalledOnUpdate=*/false>(key);
+    auto* maybe_large_page =
+        provider_.template Get</*CalledOnUpdate=*/false>(key);
+
+    const bool hit =
+        maybe_large_page != nullptr && maybe_large_page->Get(key, now, out);
+#if USE_LRU_FLAG
+    OnAccess(hit);
+#endif
+    return hit;
+  }
 
-    if (maybe_large_page == nullptr) return false;
+  void Update(TKey key, uint32_t expiration_time, const Value& value = {}) {
+#if USE_LRU_FLAG
+    if (use_lru_) {
+      // the key evicted from the LRU goes to the large page with its own
+      // expiration time and value
+      auto lru_evicted = lru_.UpdateEntry(key, expiration_time, value);
+      if (!lru_evicted) return;
 
-    return maybe_large_page->Get(key, now);
+      UpdateLargePage(lru_evicted->key, lru_evicted->expiration_time,
+                      lru_evicted->value);
+      return;
+    }
+#endif
+    UpdateLargePage(key, expiration_time, value);
   }
 
-  void Update(Key key, uint32_t expiration_time) {
+  // Batched `Get`: sets the i-th bit of `hits` (and `values[i]` if `values`
+  // is not empty) if `keys[i]` is found.
+  // Memory accesses of the keys are overlapped via software prefetching, and
+  // keys are grouped by the large page, so a swap is decided once per page.
+  void GetBatch(std::span<const TKey> keys, uint32_t now,
+                std::span<uint64_t> hits, std::span<Value> values = {}) {
+    assert(hits.size() * 64 >= keys.size());
+    assert(values.empty() || values.size() == keys.size());
+    std::fill(hits.begin(), hits.end(), 0);
+    auto value_of = [&](size_t i) {
+      return values.empty() ? nullptr : &values[i];
+    };
+
+    batch_.clear();
+#if USE_LRU_FLAG
+    if (use_lru_) PrefetchLruHead(keys);
+#endif
+    for (size_t i = 0; i < keys.size(); ++i) {
 #if USE_LRU_FLAG
-    auto lru_evicted = lru_.Update(key, expiration_time);
-    if (!lru_evicted) return;
+      if (use_lru_) {
+        if (i + kPrefetchDistance < keys.size())
+          lru_.Prefetch(keys[i + kPrefetchDistance]);
+        if (lru_.Get(keys[i], now, value_of(i))) {
+          hits[i / 64] |= 1ull << (i % 64);
+          continue;
+        }
+      }
+#endif
+      batch_.push_back({LargePageIndex(keys[i]), i, keys[i], 0, {}});
+    }
+
+    ForEachLargePage</*CalledOnUpdate=*/false>(
+        [&](TLargePage& large_page, const BatchItem& item) {
+          if (large_page.Get(item.key, now, value_of(item.position)))
+            hits[item.position / 64] |= 1ull << (item.position % 64);
+        });
 
-    key = *lru_evicted;
+#if USE_LRU_FLAG
+    if (climber_) {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        OnAccess((hits[i / 64] >> (i % 64)) & 1);
+      }
+    }
 #endif
+  }
 
-    auto* maybe_large_page = provider_.Get</*CalledOnUpdate=*/true>(key);
+  // Batched `Update`, the keys are handled as by `Update` in the order of
+  // `keys` except that the page store sees them grouped by the large page.
+  // `values` is either empty or holds the value of every key.
+  void UpdateBatch(std::span<const TKey> keys, uint32_t expiration_time,
+                   std::span<const Value> values = {}) {
+    assert(values.empty() || values.size() == keys.size());
+    batch_.clear();
+#if USE_LRU_FLAG
+    if (use_lru_) PrefetchLruHead(keys);
+#endif
+    for (size_t i = 0; i < keys.size(); ++i) {
+      const TKey key = keys[i];
+      Value value = values.empty() ? Value{} : values[i];
+#if USE_LRU_FLAG
+      if (use_lru_) {
+        if (i + kPrefetchDistance < keys.size())
+          lru_.Prefetch(keys[i + kPrefetchDistance]);
+        auto lru_evicted =
+            lru_.UpdateEntry(key, expiration_time, std::move(value));
+        if (!lru_evicted) continue;
 
-    if (maybe_large_page == nullptr) return;
+        batch_.push_back({LargePageIndex(lru_evicted->key), i,
+                          lru_evicted->key, lru_evicted->expiration_time,
+                          std::move(lru_evicted->value)});
+        continue;
+      }
+#endif
+      batch_.push_back(
+          {LargePageIndex(key), i, key, expiration_time, std::move(value)});
+    }
 
-    maybe_large_page->Update(key, expiration_time);
+    ForEachLargePage</*CalledOnUpdate=*/true>(
+        [&](TLargePage& large_page, const BatchItem& item) {
+          large_page.Update(item.key, item.expiration_time, item.value);
+        });
   }
 
-  void Store() const { provider_.Store(); }
+  void Store() { provider_.Store(); }
 
  private:
-  TTinyLFU tiny_lfu_{};
-  LargePageProvider provider_;
+  using TLargePage = typename BasicLargePageProvider<TKey, TValues>::TLargePage;
+
+  static constexpr size_t kPrefetchDistance = 8;
+  // a smaller batch is grouped by a comparison sort
+  static constexpr size_t kSortedBatchSize = 256;
+
+  struct BatchItem {
+    size_t large_page_index;
+    size_t position;  // in the batch
+    TKey key;
+    uint32_t expiration_time;  // of `Update`
+    [[no_unique_address]] Value value;
+  };
+
+  void UpdateLargePage(TKey key, uint32_t expiration_time, const Value& value) {
+    auto* maybe_large_page =
+        provider_.template Get</*CalledOnUpdate=*/true>(key);
+
+    if (maybe_large_page == nullptr) return;
+
+    maybe_large_page->Update(key, expiration_time, value);
+  }
+
+#if USE_LRU_FLAG
+  static const CacheConfig& ValidateLru(const CacheConfig& config) {
+    if (config.use_lru && config.adaptive_lru &&
+        !(config.min_lru_size <= config.lru_size &&
+          config.lru_size <= config.max_lru_size)) {
+      throw std::invalid_argument(
+          "CacheConfig::lru_size must be in [min_lru_size, max_lru_size]");
+    }
+    return config;
+  }
+
+  // An adaptive LRU takes the RAM of its largest size up front
+  static size_t LruCapacity(const CacheConfig& config) noexcept {
+    if (!config.use_lru) return 0;
+    return config.adaptive_lru ? config.max_lru_size : config.lru_size;
+  }
+
+  // Samples the hit ratio of the adaptive LRU on the keys of Get and
+  // GetBatch, the updates aren't sampled. The victims of a shrink are handled
+  // as the ones of `Update`.
+  void OnAccess(bool hit) {
+    if (!climber_) return;
+    const auto lru_size = climber_->Record(hit);
+    if (!lru_size) return;
+
+    lru_.SetMaxSize(*lru_size);
+    for (auto lru_evicted = lru_.EvictExcess(); lru_evicted;
+         lru_evicted = lru_.EvictExcess()) {
+      UpdateLargePage(lru_evicted->key, lru_evicted->expiration_time,
+                      lru_evicted->value);
+    }
+  }
+
+  void PrefetchLruHead(std::span<const TKey> keys) const noexcept {
+    for (size_t i = 0; i < std::min(keys.size(), kPrefetchDistance); ++i) {
+      lru_.Prefetch(keys[i]);
+    }
+  }
+#endif
+
+  // Stable sort of `batch_` by the large page into `grouped_batch_`. A large
+  // batch is counting sorted: only the offsets of its pages are visited, they
+  // are zero between the calls.
+  void GroupBatchByLargePage() {
+    auto by_large_page = [](const BatchItem& lhs, const BatchItem& rhs) {
+      return lhs.large_page_index < rhs.large_page_index;
+    };
+    if (batch_.size() <= kSortedBatchSize) {
+      std::stable_sort(batch_.begin(), batch_.end(), by_large_page);
+      std::swap(batch_, grouped_batch_);
+      return;
+    }
+
+    if (page_offsets_.empty()) page_offsets_.assign(LARGE_PAGE_NUMBER, 0);
+    batch_pages_.clear();
+    for (const auto& item : batch_) {
+      if (page_offsets_[item.large_page_index]++ == 0)
+        batch_pages_.push_back(item.large_page_index);
+    }
+    std::sort(batch_pages_.begin(), batch_pages_.end());
+    size_t offset = 0;
+    for (auto page : batch_pages_) {
+      offset += std::exchange(page_offsets_[page], offset);
+    }
+
+    grouped_batch_.resize(batch_.size());
+    for (auto& item : batch_) {
+      grouped_batch_[page_offsets_[item.large_page_index]++] = std::move(item);
+    }
+    for (auto page : batch_pages_) page_offsets_[page] = 0;
+  }
+
+  // Groups `batch_` by the large page and calls `handle_key` for the items
+  // of every loaded page while prefetching the small pages of next items
+  template <bool CalledOnUpdate, class Handler>
+  void ForEachLargePage(Handler&& handle_key) {
+    GroupBatchByLargePage();
+
+    for (auto first = grouped_batch_.begin(); first != grouped_batch_.end();) {
+      auto last = std::find_if(
+          first, grouped_batch_.end(), [&](const BatchItem& item) {
+            return item.large_page_index != first->large_page_index;
+          });
+      const auto count = static_cast<size_t>(std::distance(first, last));
+
+      auto* maybe_large_page =
+          provider_.template Get<CalledOnUpdate>(first->key, count);
+      if (maybe_large_page != nullptr) {
+        for (size_t i = 0; i < std::min(count, kPrefetchDistance); ++i) {
+          maybe_large_page->Prefetch(first[i].key);
+        }
+        for (size_t i = 0; i < count; ++i) {
+          if (i + kPrefetchDistance < count)
+            maybe_large_page->Prefetch(first[i + kPrefetchDistance].key);
+          handle_key(*maybe_large_page, first[i]);
+        }
+      }
+
+      first = last;
+    }
+  }
+
+  TBasicTinyLFU<TKey> tiny_lfu_{};
+  BasicLargePageProvider<TKey, TValues> provider_;
 
 #if USE_LRU_FLAG
-  LRU<uint32_t> lru_;
+  const bool use_lru_;
+  TFrontCache<TKey, Value> lru_;
+  // set if the LRU is adaptive
+  std::optional<HillClimber> climber_;
 #endif
+
+  // buffers of the batched operations
+  std::vector<BatchItem> batch_;
+  std::vector<BatchItem> grouped_batch_;
+  std::vector<size_t> page_offsets_;
+  std::vector<size_t> batch_pages_;
 };
 
+using Cache = BasicCache<>;
+using Cache64 = BasicCache<uint64_t>;
+
 }  // namespace cache
@@ -1,16 +1,26 @@
 #pragma once
 
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 
 #include <tiny_lfu_cms.hpp>
 
 namespace cache {
 
+// Keys of both widths are supported, every class of the page hierarchy is a
+// template on the key type with `Key` by default
+template <class T>
+concept CacheKey = std::same_as<T, uint32_t> || std::same_as<T, uint64_t>;
+
 using Key = uint32_t;
 
-inline const size_t INVALID_HASH = std::numeric_limits<Key>::max();
+template <CacheKey TKey>
+inline constexpr TKey INVALID_KEY = std::numeric_limits<TKey>::max();
+
+inline const size_t INVALID_HASH = INVALID_KEY<Key>;
 
 inline constexpr size_t LARGE_PAGE_SHIFT = 13;
 inline constexpr size_t SMALL_PAGE_SHIFT = 8;
@@ -18,11 +28,68 @@ inline constexpr size_t SMALL_PAGE_SIZE_SHIFT = 10;
 
 #define USE_LRU_FLAG true
 inline constexpr double LRU_SIZE = 50'000;
+// The front cache of the recent keys:
+// kLRU - `LRU`, a boost intrusive list and hash set of nodes;
+// kFlatLRU - `FlatLRU`, an array of nodes linked by 32-bit indices and an
+//            open-addressed table of the keys;
+// kSieve - `SieveCache`, the layout of kFlatLRU with SIEVE eviction: a hit
+//            only marks the entry, so the hits are read-mostly. It keeps
+//            more of the skewed keys (see lru_benchmark.cpp), but evicts
+//            other keys than the LRU does, so it's opt-in.
+enum class FrontCache { kLRU, kFlatLRU, kSieve };
+inline constexpr FrontCache FRONT_CACHE = FrontCache::kLRU;
+// Hill climbing of the LRU size (see hill_climber.hpp): the hit ratio is
+// sampled every LRU_CLIMB_PERIOD accesses and the LRU grows or shrinks within
+// [LRU_SIZE / 4, 4 * LRU_SIZE], its victims of a shrink go to the pages.
+// The accesses are the keys of Get and GetBatch: an Update fills the cache
+// after a miss, so it isn't sampled and a workload of updates only doesn't
+// move the size. The LRU takes the RAM of 4 * LRU_SIZE entries (and the
+// table of kFlatLRU and kSieve has 2 slots per entry), so it's opt-in.
+inline constexpr bool ADAPTIVE_LRU = false;
+inline constexpr double LRU_CLIMB_PERIOD = 10 * LRU_SIZE;
 
 inline constexpr size_t TLFU_SIZE = 1000;
 inline constexpr size_t SAMPLE_SIZE = TLFU_SIZE * 10;
 inline constexpr bool USE_DOOR_KEEPER = false;
-using TTinyLFU = TinyLFU<Key, SAMPLE_SIZE, TLFU_SIZE, USE_DOOR_KEEPER>;
+// All the counters of a key in a cache line: a single miss per estimation
+inline constexpr bool USE_BLOCKED_SKETCH = true;
+// 4, 8 or 16 bits of the row sketch, the blocked sketch has only 4-bit
+// counters
+inline constexpr size_t TLFU_COUNTER_BITS = 4;
+static_assert(!USE_BLOCKED_SKETCH || TLFU_COUNTER_BITS == 4,
+              "the blocked sketch has only 4-bit counters");
+// The sketch is aged by slices: raise it for the large sketches, so that no
+// addition pays for halving the whole sketch
+inline constexpr size_t TLFU_AGING_SLICES = 1;
+template <CacheKey TKey>
+using TBasicTinyLFU = TinyLFU<
+    TKey, SAMPLE_SIZE, TLFU_SIZE, USE_DOOR_KEEPER,
+    std::conditional_t<USE_BLOCKED_SKETCH, BlockedCountMinSketch<TLFU_SIZE>,
+                       CountMinSketch<TLFU_SIZE, CmsMultiplyShiftHashing,
+                                      TLFU_COUNTER_BITS>>,
+    TLFU_AGING_SLICES>;
+using TTinyLFU = TBasicTinyLFU<Key>;
+
+// Order of the records of a small page:
+// kRaise - by the estimated frequency: a hit raises the record, the victim is
+//          the last record;
+// kSampledVictim - no order: a hit doesn't move the record, the victim is the
+//          least frequent of SAMPLED_VICTIM_CANDIDATES adjacent records
+//          picked by the hash of the new key;
+// kHashed - open addressing: the hash of the key picks a bucket of
+//          SMALL_PAGE_BUCKET_SIZE adjacent slots, the key is searched and
+//          stored only there, the victim is the least frequent record of the
+//          bucket. A miss reads a single bucket instead of the whole page.
+enum class SmallPageOrdering { kRaise, kSampledVictim, kHashed };
+inline constexpr SmallPageOrdering SMALL_PAGE_ORDERING =
+    SmallPageOrdering::kRaise;
+inline constexpr size_t SAMPLED_VICTIM_CANDIDATES = 8;
+inline constexpr size_t SMALL_PAGE_BUCKET_SIZE = 16;
+// The hits of a small page are buffered and applied to the sketch and the
+// order of the records in batches: when the buffer is full or before the page
+// is modified. Most hits are a search and a store, the one draining the buffer
+// pays for all of them. 0 applies every hit at once.
+inline constexpr size_t SMALL_PAGE_READ_BUFFER_SIZE = 16;
 
 #define USE_BF_FLAG false
 #define USE_SIMD_FLAG true
@@ -77,7 +144,58 @@ inline const size_t LARGE_PAGE_PERIOD =
 
 inline const size_t FREQUENCY_THRESHOLD = 370;
 
+// Swap large pages (RAM <-> disk) on a background thread. Until the swap is
+// finished the incoming page is reported as not loaded: a Get of its keys is
+// a miss and an Update of them is dropped. Off: the swap is done by the
+// request which triggers it, as before. The default of
+// `CacheConfig::async_swap`.
+inline constexpr bool USE_ASYNC_SWAP = false;
+
+// Keep all the large pages in a single memory-mapped file instead of a file
+// per page. The file is sparse and its size is LARGE_PAGE_NUMBER * ~2.3 MiB
+// (~19 GB): it's mapped whole, so the store reserves that much address space
+// and can't be opened under a lower `ulimit -v`.
+inline constexpr bool USE_MMAP_STORE = false;
+// Unmap stored pages from the process (they stay in the page cache), which
+// keeps RSS low at the cost of page faults on the next load of the page
+inline constexpr bool MMAP_STORE_RELEASE_PAGES = false;
+
+// Read the loaded large pages from the disk on their first access instead of
+// on startup. The warm-up reads the rest of them on a background thread,
+// hottest pages first. Off: the startup reads all of them. The defaults of
+// `CacheConfig::lazy_load` and `CacheConfig::warm_up_lazy_pages`.
+inline constexpr bool USE_LAZY_LOAD = false;
+inline constexpr bool WARM_UP_LAZY_PAGES = true;
+
 inline const size_t CACHE_SIZE =
     LOADED_PAGE_NUMBER * SMALL_PAGE_NUMBER * SMALL_PAGE_SIZE;
 
+// Runtime parameters of a cache, the defaults are the constants above.
+// The geometry of the pages (LARGE_PAGE_SHIFT, SMALL_PAGE_NUMBER,
+// SMALL_PAGE_SIZE) and the sketch (TLFU_SIZE, SAMPLE_SIZE) define the
+// layout of the data, so they stay compile-time.
+struct CacheConfig {
+  // large pages kept in RAM, use `BasicCache::kLargePageSizeInBytes` to fit
+  // them into a memory budget
+  size_t loaded_page_number{LOADED_PAGE_NUMBER};
+  size_t large_page_period{LARGE_PAGE_PERIOD};
+  size_t frequency_threshold{FREQUENCY_THRESHOLD};
+  // the cache holds the keys of the large pages `i` with
+  // `i % shard_number == shard_index` only, set by `BasicShardedCache`
+  size_t shard_index{0};
+  size_t shard_number{1};
+  bool async_swap{USE_ASYNC_SWAP};
+  bool lazy_load{USE_LAZY_LOAD};
+  bool warm_up_lazy_pages{WARM_UP_LAZY_PAGES};
+
+  bool use_lru{USE_LRU};
+  size_t lru_size{static_cast<size_t>(LRU_SIZE)};
+  // the initial size of an adaptive LRU is `lru_size`, the LRU takes the RAM
+  // of `max_lru_size` entries
+  bool adaptive_lru{ADAPTIVE_LRU};
+  size_t min_lru_size{static_cast<size_t>(LRU_SIZE / 4)};
+  size_t max_lru_size{static_cast<size_t>(4 * LRU_SIZE)};
+  size_t lru_climb_period{static_cast<size_t>(LRU_CLIMB_PERIOD)};
+};
+
 }  // namespace cache
@@ -7,14 +7,22 @@ https://github.com/hypermodeinc/ristretto/blob/010b2dd22a2ef179ebbc3a916cc5c863c
 
 */
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <bit>
 #include <cassert>
+#include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <random>
+#include <type_traits>
+#include <utility>
 
+#include "simd.hpp"
 #include "utils.hpp"
 
 namespace cache {
@@ -23,30 +31,111 @@ namespace details {
 
 constexpr size_t CM_DEPTH = 4;
 
-template <uint32_t NumCounters>
+// Counters are indexed by 32-bit hashes. The high half of a 64-bit key is
+// mixed into the low one (a plain truncation would merge all the keys which
+// differ in the high bits only). A key below 2^32 is hashed as is, whatever
+// its type.
+template <std::integral T>
+constexpr uint32_t FoldKey(T key) noexcept {
+  if constexpr (sizeof(T) <= sizeof(uint32_t)) {
+    return static_cast<uint32_t>(key);
+  } else {
+    const auto high = static_cast<uint64_t>(key) >> 32;
+    return static_cast<uint32_t>(key) ^
+           static_cast<uint32_t>((high * 0x9E3779B97F4A7C15ull) >> 32);
+  }
+}
+
+// The counters of `CounterBits` bits halved at once: (word >> 1) & mask, the
+// mask drops the bit shifted into the top bit of every counter, e.g. 4 bits:
+// 0011 1011 (shift)-> 0001 1101 (mask 0111 0111)-> 0001 0101
+template <size_t CounterBits>
+inline constexpr uint64_t kHalveMask =
+    ~0ull / ((1ull << CounterBits) - 1) * ((1ull << (CounterBits - 1)) - 1);
+
+// Halves the counters of `size` bytes, `size` is a multiple of the counter
+template <size_t CounterBits = 4>
+inline void HalveCounters(uint8_t* data, size_t size) noexcept {
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    word = (word >> 1) & kHalveMask<CounterBits>;
+    std::memcpy(data + i, &word, sizeof(word));
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, size - i);
+    word = (word >> 1) & kHalveMask<CounterBits>;
+    std::memcpy(data + i, &word, size - i);
+  }
+}
+
+template <size_t CounterBits = 4>
+CACHE_TARGET("avx2")
+inline void HalveCountersAVX2(uint8_t* data, size_t size) noexcept {
+  const auto mask =
+      _mm256_set1_epi64x(static_cast<int64_t>(kHalveMask<CounterBits>));
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= size; i += sizeof(__m256i)) {
+    auto* block = reinterpret_cast<__m256i*>(data + i);
+    const auto halved = _mm256_srli_epi16(_mm256_loadu_si256(block), 1);
+    _mm256_storeu_si256(block, _mm256_and_si256(halved, mask));
+  }
+  HalveCounters<CounterBits>(data + i, size - i);
+}
+
+template <size_t CounterBits = 4>
+inline void AgeCounters(uint8_t* data, size_t size) noexcept {
+  if (kSimdLevel >= SimdLevel::kAVX2) {
+    HalveCountersAVX2<CounterBits>(data, size);
+  } else {
+    HalveCounters<CounterBits>(data, size);
+  }
+}
+
+// The bytes [begin, end) of the slice `slice` of `num_slices` of `size` bytes
+constexpr std::pair<size_t, size_t> GetSlice(size_t size, size_t slice,
+                                             size_t num_slices) noexcept {
+  return {size * slice / num_slices, size * (slice + 1) / num_slices};
+}
+
+// `NumCounters` counters of `CounterBits` bits: 4-bit counters are packed by
+// two in a byte
+template <uint32_t NumCounters, size_t CounterBits = 4>
+  requires(CounterBits == 4 || CounterBits == 8 || CounterBits == 16)
 class Row {
+  using TCell = std::conditional_t<CounterBits == 16, uint16_t, uint8_t>;
+  constexpr static size_t kCountersPerCell = 8 * sizeof(TCell) / CounterBits;
+
  public:
-  constexpr static uint8_t MAX_COUNT = 15;
+  using TCount = TCell;
+  constexpr static TCount MAX_COUNT = (1u << CounterBits) - 1;
 
-  uint8_t Get(uint32_t value) const noexcept {
-    return (data_[value / 2] >> ((value % 2) * 4)) % (MAX_COUNT + 1);
+  TCount Get(uint32_t value) const noexcept {
+    return (data_[value / kCountersPerCell] >> GetShift(value)) & MAX_COUNT;
   }
 
   void Add(uint32_t value) noexcept {
-    const uint32_t idx =
-        value / 2;  // divide by 2 because data.size() == NumCounters / 2
-    const uint8_t shift = (value % 2) * 4;  // possible values: 0, 4
-    const uint8_t count = (data_[idx] >> shift) % (MAX_COUNT + 1);
-    if (count < MAX_COUNT) data_[idx] += (1 << shift);  // add 1 to the counter
+    auto& cell = data_[value / kCountersPerCell];
+    const auto shift = GetShift(value);
+    const TCount count = (cell >> shift) & MAX_COUNT;
+    if (count < MAX_COUNT) cell += TCell{1} << shift;  // add 1 to the counter
+  }
+
+  void Prefetch(uint32_t value) const noexcept {
+    __builtin_prefetch(&data_[value / kCountersPerCell]);
   }
 
   void Reset() noexcept {
-    constexpr static size_t RESET_MASK = 0x77;  // 0111 0111
-    for (auto& byte : data_) {
-      // reset each counter, e.g. 0011 1011 (shift)-> 0001 1101 (mask)-> 0001
-      // 0101
-      byte = (byte >> 1) & RESET_MASK;
-    }
+    AgeCounters<CounterBits>(reinterpret_cast<uint8_t*>(data_.data()),
+                             sizeof(data_));
+  }
+
+  void ResetSlice(size_t slice, size_t num_slices) noexcept {
+    const auto [begin, end] = GetSlice(data_.size(), slice, num_slices);
+    AgeCounters<CounterBits>(reinterpret_cast<uint8_t*>(data_.data() + begin),
+                             (end - begin) * sizeof(TCell));
   }
 
   void Clear() noexcept { data_.fill(0); }
@@ -56,57 +145,161 @@ class Row {
   }
 
   void Load(std::ifstream& file) {
-    utils::BinaryRead(file, data_.data(), data_.size());
+    utils::BinaryRead(file, data_.data(), sizeof(data_));
   }
 
   void Store(std::ofstream& file) const {
-    utils::BinaryWrite(file, data_.data(), data_.size());
+    utils::BinaryWrite(file, data_.data(), sizeof(data_));
   }
 
  private:
-  std::array<uint8_t, NumCounters / 2>
-      data_{};  // data.size() == NumCounters / 2 because each byte contains two
-                // 4-bit counters
+  static uint32_t GetShift(uint32_t value) noexcept {
+    return value % kCountersPerCell * CounterBits;
+  }
+
+  std::array<TCell, NumCounters / kCountersPerCell> data_{};
 };
 
 }  // namespace details
 
-template <uint32_t NumCounters>
+// Hashing policies of the sketch: map a key to a counter of every row.
+// `NumCounters` is a power of two. The seeds are random and persisted with
+// the sketch.
+
+// The key XOR a seed per row: keeps only the low bits of the key, so the keys
+// which differ in the high bits only collide in all the rows
+class CmsXorSeedHashing {
+ public:
+  CmsXorSeedHashing() {
+    std::random_device rd;
+    std::mt19937 rng(rd());
+    for (auto& seed : seeds_) seed = rng();
+  }
+
+  template <uint32_t NumCounters, std::integral T>
+  std::array<uint32_t, details::CM_DEPTH> GetIndices(T key) const noexcept {
+    const uint32_t hash = details::FoldKey(key);
+    std::array<uint32_t, details::CM_DEPTH> indices;
+    for (size_t i = 0; i < details::CM_DEPTH; i++) {
+      indices[i] = (hash ^ seeds_[i]) % NumCounters;
+    }
+    return indices;
+  }
+
+  void Load(std::ifstream& file) {
+    utils::BinaryRead(file, seeds_.data(), seeds_.size() * sizeof(seeds_[0]));
+  }
+
+  void Store(std::ofstream& file) const {
+    utils::BinaryWrite(file, seeds_.data(), seeds_.size() * sizeof(seeds_[0]));
+  }
+
+ private:
+  std::array<uint32_t, details::CM_DEPTH> seeds_{};
+};
+
+// A single seeded multiply-shift hash of the whole key: the rows take
+// disjoint slices of it, from the top bits (the best mixed ones) down. A key
+// is hashed by its value, whatever its type.
+class CmsMultiplyShiftHashing {
+ public:
+  CmsMultiplyShiftHashing() {
+    std::random_device rd;
+    std::mt19937_64 rng(rd());
+    seed_ = rng();
+    multiplier_ = rng() | 1;
+  }
+
+  // All the bits of the hash depend on all the bits of the key
+  template <std::integral T>
+  uint64_t Hash(T key) const noexcept {
+    const uint64_t hash = (static_cast<uint64_t>(key) ^ seed_) * multiplier_;
+    // the low bits of the product depend only on the low bits of the key
+    return hash ^ (hash >> 32);
+  }
+
+  template <uint32_t NumCounters, std::integral T>
+  std::array<uint32_t, details::CM_DEPTH> GetIndices(T key) const noexcept {
+    constexpr uint32_t kBits = std::countr_zero(NumCounters);
+    constexpr uint32_t kRowsPerHash = 64 / kBits;
+
+    uint64_t hash = Hash(key);
+    std::array<uint32_t, details::CM_DEPTH> indices;
+    for (uint32_t i = 0; i < details::CM_DEPTH; i++) {
+      if (i > 0 && i % kRowsPerHash == 0) hash = utils::Mix64(hash);
+      const uint32_t shift = 64 - kBits * (i % kRowsPerHash + 1);
+      indices[i] = static_cast<uint32_t>(hash >> shift) & (NumCounters - 1);
+    }
+    return indices;
+  }
+
+  void Load(std::ifstream& file) {
+    utils::BinaryRead(file, &seed_, sizeof(seed_));
+    utils::BinaryRead(file, &multiplier_, sizeof(multiplier_));
+  }
+
+  void Store(std::ofstream& file) const {
+    utils::BinaryWrite(file, &seed_, sizeof(seed_));
+    utils::BinaryWrite(file, &multiplier_, sizeof(multiplier_));
+  }
+
+ private:
+  uint64_t seed_{0};
+  uint64_t multiplier_{1};
+};
+
+// `CounterBits` is 4, 8 or 16: wider counters saturate later (the frequent
+// keys stay comparable) at the cost of 2 or 4 times more memory
+template <uint32_t NumCounters, class THashing = CmsMultiplyShiftHashing,
+          size_t CounterBits = 4>
   requires(NumCounters > 0)
 class CountMinSketch {
  public:
   constexpr static uint32_t kNumCounters = std::bit_ceil(NumCounters);
   static_assert(kNumCounters > 1);
 
-  using TRow = details::Row<kNumCounters>;
+  using TRow = details::Row<kNumCounters, CounterBits>;
+  using TCount = typename TRow::TCount;
 
-  CountMinSketch() {
-    std::random_device rd;
-    std::mt19937 rng(rd());
+  template <std::integral T>
+  void Add(T key) noexcept {
+    const auto indices = hashing_.template GetIndices<kNumCounters>(key);
     for (size_t i = 0; i < details::CM_DEPTH; i++) {
-      seeds_[i] = rng();
+      rows_[i].Add(indices[i]);
     }
   }
 
-  void Add(uint32_t key) noexcept {
+  template <std::integral T>
+  TCount Estimate(T key) const noexcept {
+    const auto indices = hashing_.template GetIndices<kNumCounters>(key);
+    auto min_count = std::numeric_limits<TCount>::max();
     for (size_t i = 0; i < details::CM_DEPTH; i++) {
-      rows_[i].Add((key ^ seeds_[i]) % kNumCounters);
+      auto count = rows_[i].Get(indices[i]);
+      min_count = std::min(min_count, count);
     }
+    return min_count;
   }
 
-  uint8_t Estimate(uint32_t key) const noexcept {
-    auto min_count = std::numeric_limits<uint8_t>::max();
+  // Prefetches the counters of the key, a row after another
+  template <std::integral T>
+  void Prefetch(T key) const noexcept {
+    const auto indices = hashing_.template GetIndices<kNumCounters>(key);
     for (size_t i = 0; i < details::CM_DEPTH; i++) {
-      auto count = rows_[i].Get((key ^ seeds_[i]) % kNumCounters);
-      min_count = std::min(min_count, count);
+      rows_[i].Prefetch(indices[i]);
     }
-    return min_count;
   }
 
   void Reset() noexcept {
     for (auto& row : rows_) row.Reset();
   }
 
+  // Halves the slice `slice` of `num_slices` of every row: halving all the
+  // slices one by one is a Reset spread over time
+  void ResetSlice(size_t slice, size_t num_slices) noexcept {
+    assert(slice < num_slices);
+    for (auto& row : rows_) row.ResetSlice(slice, num_slices);
+  }
+
   void Clear() noexcept {
     for (auto& row : rows_) row.Clear();
   }
@@ -117,24 +310,303 @@ class CountMinSketch {
     for (auto& row : rows_) {
       row.Load(file);
     }
-    utils::BinaryRead(file, seeds_.data(), seeds_.size() * sizeof(seeds_[0]));
+    hashing_.Load(file);
   }
 
   void Store(std::ofstream& file) const {
     for (auto& row : rows_) {
       row.Store(file);
     }
-    utils::BinaryWrite(file, seeds_.data(), seeds_.size() * sizeof(seeds_[0]));
+    hashing_.Store(file);
   }
 
   bool operator==(const CountMinSketch& other) const noexcept {
     return rows_ == other.rows_;
-    // && seeds_ == other.seeds_ // seeds may differ
+    // && hashing_ == other.hashing_ // seeds may differ
   }
 
  private:
-  std::array<TRow, details::CM_DEPTH> rows_{};       // 2 * kNumCounters bytes
-  std::array<uint32_t, details::CM_DEPTH> seeds_{};  // 16 bytes
+  std::array<TRow, details::CM_DEPTH> rows_{};  // 2 * kNumCounters bytes
+  THashing hashing_;                            // 16 bytes
+};
+
+namespace details {
+
+// A block of the blocked sketch: 8 words of 16 4-bit counters, the row `i` of
+// the sketch is the words 2i and 2i + 1. A key has a counter in every row of
+// its block: bits [5i, 5i + 5) of the hash pick the word and the counter.
+inline constexpr size_t kSketchBlockWords = 8;
+
+inline uint8_t EstimateInBlock(const uint64_t* block, uint64_t hash) noexcept {
+  uint8_t min_count = 15;
+  for (size_t i = 0; i < CM_DEPTH; ++i) {
+    const auto counter = (hash >> (5 * i)) & 31;
+    const auto word = block[2 * i + (counter >> 4)];
+    min_count = std::min<uint8_t>(min_count, (word >> (counter & 15) * 4) & 15);
+  }
+  return min_count;
+}
+
+inline void AddToBlock(uint64_t* block, uint64_t hash) noexcept {
+  for (size_t i = 0; i < CM_DEPTH; ++i) {
+    const auto counter = (hash >> (5 * i)) & 31;
+    auto& word = block[2 * i + (counter >> 4)];
+    const auto shift = (counter & 15) * 4;
+    if (((word >> shift) & 15) < 15) word += 1ull << shift;
+  }
+}
+
+// The shifts of the counters of the key in the words of the half of its block
+// (rows 2 * half and 2 * half + 1), the words without a counter get a shift of
+// 64: AVX2 shifts them out entirely
+CACHE_TARGET("avx2")
+inline __m256i GetBlockShiftsAVX2(uint64_t hash, size_t half) noexcept {
+  const auto offset = static_cast<int64_t>(10 * half);
+  const auto counters = _mm256_and_si256(
+      _mm256_srlv_epi64(_mm256_set1_epi64x(static_cast<int64_t>(hash)),
+                        _mm256_setr_epi64x(offset, offset, offset + 5,
+                                           offset + 5)),
+      _mm256_set1_epi64x(31));
+  // the word of a counter is its bit 4
+  const auto in_word =
+      _mm256_cmpeq_epi64(_mm256_srli_epi64(counters, 4),
+                         _mm256_setr_epi64x(0, 1, 0, 1));
+  const auto shifts = _mm256_slli_epi64(
+      _mm256_and_si256(counters, _mm256_set1_epi64x(15)), 2);
+  return _mm256_blendv_epi8(_mm256_set1_epi64x(64), shifts, in_word);
+}
+
+CACHE_TARGET("avx2")
+inline __m256i GetBlockCountersAVX2(__m256i words, __m256i shifts) noexcept {
+  // the words without a counter of the key read 15: they don't lower the min
+  const auto fifteen = _mm256_set1_epi64x(15);
+  const auto absent = _mm256_cmpeq_epi64(shifts, _mm256_set1_epi64x(64));
+  const auto counters =
+      _mm256_and_si256(_mm256_srlv_epi64(words, shifts), fifteen);
+  return _mm256_or_si256(counters, _mm256_and_si256(absent, fifteen));
+}
+
+CACHE_TARGET("avx2")
+inline uint8_t EstimateInBlockAVX2(const uint64_t* block,
+                                   uint64_t hash) noexcept {
+  const auto* data = reinterpret_cast<const __m256i*>(block);
+  const auto low = GetBlockCountersAVX2(_mm256_load_si256(data),
+                                        GetBlockShiftsAVX2(hash, 0));
+  const auto high = GetBlockCountersAVX2(_mm256_load_si256(data + 1),
+                                         GetBlockShiftsAVX2(hash, 1));
+  // the counters are in the low 32 bits of the words, the high ones are 0
+  auto min = _mm256_min_epu32(low, high);
+  min = _mm256_min_epu32(min, _mm256_shuffle_epi32(min, 0b01001110));
+  const auto quad = _mm_min_epu32(_mm256_castsi256_si128(min),
+                                  _mm256_extracti128_si256(min, 1));
+  return static_cast<uint8_t>(_mm_cvtsi128_si32(quad));
+}
+
+CACHE_TARGET("avx2")
+inline void AddToBlockAVX2(uint64_t* block, uint64_t hash) noexcept {
+  auto* data = reinterpret_cast<__m256i*>(block);
+  const auto fifteen = _mm256_set1_epi64x(15);
+  for (size_t half = 0; half < 2; ++half) {
+    const auto words = _mm256_load_si256(data + half);
+    const auto shifts = GetBlockShiftsAVX2(hash, half);
+    const auto counters = GetBlockCountersAVX2(words, shifts);
+    // 1 for the counters below the max, the words without a counter read 15
+    const auto increments =
+        _mm256_andnot_si256(_mm256_cmpeq_epi64(counters, fifteen),
+                            _mm256_set1_epi64x(1));
+    _mm256_store_si256(
+        data + half,
+        _mm256_add_epi64(words, _mm256_sllv_epi64(increments, shifts)));
+  }
+}
+
+}  // namespace details
+
+// 4-bit counters CountMinSketch where all the counters of a key are in a
+// single 64-byte block (the layout of Caffeine's FrequencySketch), so an
+// access is a single cache miss however large the sketch is. Same memory as
+// `CountMinSketch`, but at least a block.
+template <uint32_t NumCounters>
+  requires(NumCounters > 0)
+class BlockedCountMinSketch {
+ public:
+  constexpr static uint32_t kNumCounters = std::bit_ceil(NumCounters);
+  constexpr static size_t kNumBlocks = std::max<size_t>(
+      1, kNumCounters * details::CM_DEPTH / 16 / details::kSketchBlockWords);
+
+  template <std::integral T>
+  void Add(T key) noexcept {
+    const auto hash = hashing_.Hash(key);
+    if (kSimdLevel >= SimdLevel::kAVX2) {
+      details::AddToBlockAVX2(GetBlock(hash), hash);
+    } else {
+      details::AddToBlock(GetBlock(hash), hash);
+    }
+  }
+
+  template <std::integral T>
+  uint8_t Estimate(T key) const noexcept {
+    const auto hash = hashing_.Hash(key);
+    if (kSimdLevel >= SimdLevel::kAVX2) {
+      return details::EstimateInBlockAVX2(GetBlock(hash), hash);
+    }
+    return details::EstimateInBlock(GetBlock(hash), hash);
+  }
+
+  template <std::integral T>
+  void Prefetch(T key) const noexcept {
+    __builtin_prefetch(GetBlock(hashing_.Hash(key)));
+  }
+
+  void Reset() noexcept { ResetSlice(0, 1); }
+
+  void ResetSlice(size_t slice, size_t num_slices) noexcept {
+    assert(slice < num_slices);
+    const auto [begin, end] =
+        details::GetSlice(sizeof(table_), slice, num_slices);
+    details::AgeCounters(reinterpret_cast<uint8_t*>(table_.data()) + begin,
+                         end - begin);
+  }
+
+  void Clear() noexcept { table_.fill(0); }
+
+  void Load(std::ifstream& file) {
+    utils::BinaryRead(file, table_.data(), table_.size() * sizeof(table_[0]));
+    hashing_.Load(file);
+  }
+
+  void Store(std::ofstream& file) const {
+    utils::BinaryWrite(file, table_.data(), table_.size() * sizeof(table_[0]));
+    hashing_.Store(file);
+  }
+
+  bool operator==(const BlockedCountMinSketch& other) const noexcept {
+    return table_ == other.table_;
+  }
+
+ private:
+  // the high half of the hash picks the block, the low one the counters
+  uint64_t* GetBlock(uint64_t hash) noexcept {
+    return &table_[((hash >> 32) & (kNumBlocks - 1)) *
+                   details::kSketchBlockWords];
+  }
+
+  const uint64_t* GetBlock(uint64_t hash) const noexcept {
+    return &table_[((hash >> 32) & (kNumBlocks - 1)) *
+                   details::kSketchBlockWords];
+  }
+
+  alignas(64)
+      std::array<uint64_t, kNumBlocks * details::kSketchBlockWords> table_{};
+  CmsMultiplyShiftHashing hashing_;
+};
+
+// BlockedCountMinSketch safe to update from many threads without a lock: a
+// counter is incremented with a CAS of its 64-bit word, relaxed since the
+// estimations are approximate anyway. A halving racing an increment may lose
+// the increment. Load and Clear must not race the other calls.
+template <uint32_t NumCounters>
+  requires(NumCounters > 0)
+class ConcurrentBlockedCountMinSketch {
+ public:
+  constexpr static uint32_t kNumCounters = std::bit_ceil(NumCounters);
+  constexpr static size_t kNumBlocks =
+      BlockedCountMinSketch<NumCounters>::kNumBlocks;
+
+  template <std::integral T>
+  void Add(T key) noexcept {
+    const auto hash = hashing_.Hash(key);
+    auto* block = GetBlock(hash);
+    for (size_t i = 0; i < details::CM_DEPTH; ++i) {
+      const auto counter = (hash >> (5 * i)) & 31;
+      auto& word = block[2 * i + (counter >> 4)];
+      const auto shift = (counter & 15) * 4;
+      auto value = word.load(std::memory_order_relaxed);
+      while (((value >> shift) & 15) < 15 &&
+             !word.compare_exchange_weak(value, value + (1ull << shift),
+                                         std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  template <std::integral T>
+  uint8_t Estimate(T key) const noexcept {
+    const auto hash = hashing_.Hash(key);
+    const auto* block = GetBlock(hash);
+    uint8_t min_count = 15;
+    for (size_t i = 0; i < details::CM_DEPTH; ++i) {
+      const auto counter = (hash >> (5 * i)) & 31;
+      const auto word =
+          block[2 * i + (counter >> 4)].load(std::memory_order_relaxed);
+      min_count =
+          std::min<uint8_t>(min_count, (word >> (counter & 15) * 4) & 15);
+    }
+    return min_count;
+  }
+
+  void Reset() noexcept { ResetSlice(0, 1); }
+
+  void ResetSlice(size_t slice, size_t num_slices) noexcept {
+    assert(slice < num_slices);
+    const auto [begin, end] =
+        details::GetSlice(table_.size(), slice, num_slices);
+    for (size_t i = begin; i < end; ++i) {
+      auto value = table_[i].load(std::memory_order_relaxed);
+      while (!table_[i].compare_exchange_weak(
+          value, (value >> 1) & 0x7777777777777777ull,
+          std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  void Clear() noexcept {
+    for (auto& word : table_) word.store(0, std::memory_order_relaxed);
+  }
+
+  void Load(std::ifstream& file) {
+    for (auto& word : table_) {
+      uint64_t value;
+      utils::BinaryRead(file, &value, sizeof(value));
+      word.store(value, std::memory_order_relaxed);
+    }
+    hashing_.Load(file);
+  }
+
+  void Store(std::ofstream& file) const {
+    for (const auto& word : table_) {
+      const uint64_t value = word.load(std::memory_order_relaxed);
+      utils::BinaryWrite(file, &value, sizeof(value));
+    }
+    hashing_.Store(file);
+  }
+
+  bool operator==(const ConcurrentBlockedCountMinSketch& other) const noexcept {
+    for (size_t i = 0; i < table_.size(); ++i) {
+      if (table_[i].load(std::memory_order_relaxed) !=
+          other.table_[i].load(std::memory_order_relaxed)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  using TWord = std::atomic<uint64_t>;
+  static_assert(TWord::is_always_lock_free);
+
+  TWord* GetBlock(uint64_t hash) noexcept {
+    return &table_[((hash >> 32) & (kNumBlocks - 1)) *
+                   details::kSketchBlockWords];
+  }
+
+  const TWord* GetBlock(uint64_t hash) const noexcept {
+    return &table_[((hash >> 32) & (kNumBlocks - 1)) *
+                   details::kSketchBlockWords];
+  }
+
+  alignas(64)
+      std::array<TWord, kNumBlocks * details::kSketchBlockWords> table_{};
+  CmsMultiplyShiftHashing hashing_;
 };
 
 }  // namespace cache
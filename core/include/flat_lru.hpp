@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <lru.hpp>
+#include <utils.hpp>
+
+namespace cache {
+
+// The entry evicted by a flat cache:
+// kLRU - the least recently used one, a hit moves the entry to the back of
+//        the list;
+// kSieve - SIEVE: a hit only marks the entry as visited, the hand walks the
+//        list from the oldest entry to the newest one, unmarking the visited
+//        entries, and evicts the first unvisited one. The hits don't write
+//        the list, so they don't dirty the cache lines of the neighbours.
+enum class FlatEviction { kLRU, kSieve };
+
+// A cache with the interface of `LRU` and no pointers: the entries are nodes
+// of an array linked into a list by 32-bit indices, and the keys are found
+// in an open-addressed table of (key, node index) slots with linear probing.
+// With 32-bit keys an entry takes a 16-byte node and 2 slots of 8 bytes
+// instead of a node with 3 hooks and a bucket, and a lookup probes adjacent
+// slots instead of chasing a bucket chain.
+template <class Key, class Hash, class Equal, class Value,
+          FlatEviction Eviction>
+class BasicFlatCache final {
+ public:
+  struct Entry {
+    Key key;
+    uint32_t expiration_time;
+    Value value;
+  };
+
+  // `max_size` is also the capacity: the largest size of `SetMaxSize`
+  explicit BasicFlatCache(size_t max_size)
+      : capacity_(max_size ? max_size : 1),
+        max_size_(capacity_),
+        // the load factor of the table is below 1/2: the probe sequences are
+        // short and always end at an empty slot
+        table_(2 * capacity_ + 1),
+        nodes_(capacity_ + 1),
+        values_(capacity_),
+        visited_(Eviction == FlatEviction::kSieve ? capacity_ : 0) {
+    assert(table_.size() < kNil);
+    nodes_[head_].prev = nodes_[head_].next = head_;
+  }
+
+  BasicFlatCache(BasicFlatCache&& cache) = delete;
+  BasicFlatCache(const BasicFlatCache& cache) = delete;
+
+  BasicFlatCache& operator=(BasicFlatCache&& cache) = delete;
+  BasicFlatCache& operator=(const BasicFlatCache& cache) = delete;
+
+  std::optional<Key> Update(Key key, uint32_t expiration_time) {
+    auto evicted = UpdateEntry(std::move(key), expiration_time, Value{});
+    if (!evicted) return std::nullopt;
+    return std::move(evicted->key);
+  }
+
+  // Returns the evicted entry (if any) to be passed to the next cache level
+  std::optional<Entry> UpdateEntry(Key key, uint32_t expiration_time,
+                                   Value value) {
+    auto pos = FindSlot(key);
+    if (pos != kNoSlot) {
+      const auto index = table_[pos].index;
+      nodes_[index].expiration_time = expiration_time;
+      values_[index] = std::move(value);
+      OnHit(index);
+      return std::nullopt;
+    }
+
+    std::optional<Entry> evicted;
+    uint32_t index;
+    if (size_ >= max_size_) {
+      index = PickVictim();
+      auto& node = nodes_[index];
+      evicted.emplace(Entry{node.key, node.expiration_time,
+                            std::move(values_[index])});
+      EraseSlot(FindSlot(node.key));
+      Unlink(index);
+    } else if (free_head_ != kNil) {
+      index = free_head_;
+      free_head_ = nodes_[index].next;
+      ++size_;
+    } else {
+      index = used_++;
+      ++size_;
+    }
+
+    for (pos = Home(key); table_[pos].index != kNil; pos = Next(pos)) {
+    }
+    table_[pos] = Slot{key, index};
+    nodes_[index].key = key;
+    nodes_[index].expiration_time = expiration_time;
+    values_[index] = std::move(value);
+    if constexpr (Eviction == FlatEviction::kSieve) visited_[index] = 0;
+    LinkBack(index);
+
+    return evicted;
+  }
+
+  size_t MaxSize() const noexcept { return max_size_; }
+
+  // A shrink doesn't evict by itself, the entries beyond `max_size` are
+  // taken by `EvictExcess`
+  void SetMaxSize(size_t max_size) noexcept {
+    assert(max_size <= capacity_);
+    max_size_ = max_size ? max_size : 1;
+  }
+
+  // Evicts the entry picked by `Eviction` if the size exceeds the max one
+  std::optional<Entry> EvictExcess() {
+    if (size_ <= max_size_) return std::nullopt;
+
+    const auto index = PickVictim();
+    const auto& node = nodes_[index];
+    Entry evicted{node.key, node.expiration_time, std::move(values_[index])};
+    Free(index, FindSlot(node.key));
+    return evicted;
+  }
+
+  // Prefetches the home slot of the key to hide the cache miss of a
+  // following Get/Update
+  void Prefetch(const Key& key) const noexcept {
+    __builtin_prefetch(&table_[Home(key)]);
+  }
+
+  // `out` (if any) receives the value of the key on a hit
+  bool Get(Key key, uint32_t now, Value* out = nullptr) {
+    const auto pos = FindSlot(key);
+    if (pos == kNoSlot) return false;
+
+    const auto index = table_[pos].index;
+    if (details::ShouldEvict(nodes_[index].expiration_time, now)) {
+      Free(index, pos);
+      return false;
+    }
+
+    if (out != nullptr) *out = values_[index];
+    OnHit(index);
+    return true;
+  }
+
+ private:
+  static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kNoSlot = std::numeric_limits<size_t>::max();
+
+  struct Slot {
+    Key key{};
+    uint32_t index{kNil};
+  };
+
+  struct Node {
+    Key key{};
+    uint32_t expiration_time{0};
+    uint32_t prev{kNil};
+    uint32_t next{kNil};
+  };
+
+  // Maps the high 32 bits of the multiplicative hash to [0, table size)
+  size_t Home(const Key& key) const noexcept {
+    const uint64_t hash = Hash{}(key) * 0x9E3779B97F4A7C15ull;
+    return ((hash >> 32) * table_.size()) >> 32;
+  }
+
+  size_t Next(size_t pos) const noexcept {
+    return pos + 1 == table_.size() ? 0 : pos + 1;
+  }
+
+  // The number of slots from `from` forward to `to`
+  size_t Distance(size_t from, size_t to) const noexcept {
+    return to >= from ? to - from : to + table_.size() - from;
+  }
+
+  // The position of the slot of the key or kNoSlot
+  size_t FindSlot(const Key& key) const noexcept {
+    for (auto pos = Home(key);; pos = Next(pos)) {
+      if (table_[pos].index == kNil) return kNoSlot;
+      if (Equal{}(table_[pos].key, key)) return pos;
+    }
+  }
+
+  // Backward shift deletion: the following slots of the probe sequence are
+  // moved back, so the table needs no tombstones
+  void EraseSlot(size_t pos) noexcept {
+    for (auto next = Next(pos); table_[next].index != kNil; next = Next(next)) {
+      if (Distance(Home(table_[next].key), next) >= Distance(pos, next)) {
+        table_[pos] = table_[next];
+        pos = next;
+      }
+    }
+    table_[pos] = Slot{};
+  }
+
+  // The list is circular through the node `head_`: the least recent (oldest
+  // for kSieve) node is its next one, the most recent (newest) node is its
+  // previous one
+  void Unlink(uint32_t index) noexcept {
+    const auto& node = nodes_[index];
+    nodes_[node.prev].next = node.next;
+    nodes_[node.next].prev = node.prev;
+  }
+
+  void LinkBack(uint32_t index) noexcept {
+    auto& node = nodes_[index];
+    node.prev = nodes_[head_].prev;
+    node.next = head_;
+    nodes_[node.prev].next = index;
+    nodes_[head_].prev = index;
+  }
+
+  // Removes the node and its slot at `pos`, the node goes to the free list
+  void Free(uint32_t index, size_t pos) noexcept {
+    EraseSlot(pos);
+    if constexpr (Eviction == FlatEviction::kSieve) {
+      if (index == hand_) hand_ = nodes_[index].next;
+    }
+    Unlink(index);
+    nodes_[index].next = free_head_;
+    free_head_ = index;
+    --size_;
+  }
+
+  void OnHit(uint32_t index) noexcept {
+    if constexpr (Eviction == FlatEviction::kSieve) {
+      // a read of a marked entry stays a read
+      if (!visited_[index]) visited_[index] = 1;
+    } else {
+      if (nodes_[head_].prev == index) return;
+      Unlink(index);
+      LinkBack(index);
+    }
+  }
+
+  // The node to evict, it's still linked
+  uint32_t PickVictim() noexcept {
+    if constexpr (Eviction == FlatEviction::kSieve) {
+      // `hand_` == `head_` restarts from the oldest node
+      auto hand = hand_;
+      for (;; hand = nodes_[hand].next) {
+        if (hand == head_) hand = nodes_[head_].next;
+        if (!visited_[hand]) break;
+        visited_[hand] = 0;
+      }
+      hand_ = nodes_[hand].next;
+      return hand;
+    } else {
+      return nodes_[head_].next;
+    }
+  }
+
+  const size_t capacity_;
+  size_t max_size_;
+  const uint32_t head_ = static_cast<uint32_t>(capacity_);
+
+  std::vector<Slot> table_;
+  std::vector<Node> nodes_;
+  std::vector<Value> values_;
+  // kSieve only
+  std::vector<uint8_t> visited_;
+  uint32_t hand_ = head_;
+
+  size_t size_{0};
+  // nodes [0, used_) were taken, the freed ones are linked via `next`
+  uint32_t used_{0};
+  uint32_t free_head_{kNil};
+};
+
+template <class Key, class Hash = std::hash<Key>,
+          class Equal = std::equal_to<Key>, class Value = NoValue>
+using FlatLRU = BasicFlatCache<Key, Hash, Equal, Value, FlatEviction::kLRU>;
+
+template <class Key, class Hash = std::hash<Key>,
+          class Equal = std::equal_to<Key>, class Value = NoValue>
+using SieveCache =
+    BasicFlatCache<Key, Hash, Equal, Value, FlatEviction::kSieve>;
+
+}  // namespace cache
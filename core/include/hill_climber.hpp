@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+
+namespace cache {
+
+// Adapts the size of the front cache to the workload as the adaptive
+// W-TinyLFU of Caffeine does. The hit ratio of every period is compared with
+// the one of the previous period: the size keeps moving in the same direction
+// while the hit ratio grows and turns back when it drops. The step decays, so
+// the size settles on a stable workload, and gets its full length back when
+// the hit ratio jumps, i.e. when the workload changes.
+class HillClimber final {
+ public:
+  static constexpr double kStepFraction = 0.0625;  // of `max_size`
+  static constexpr double kStepDecay = 0.98;
+  static constexpr double kRestartThreshold = 0.05;
+
+  // `size` in [`min_size`, `max_size`] is the initial size, a period is
+  // `period` accesses
+  HillClimber(size_t min_size, size_t max_size, size_t size, size_t period)
+      : min_size_(min_size),
+        max_size_(max_size),
+        period_(period ? period : 1),
+        size_(size),
+        full_step_(kStepFraction * static_cast<double>(max_size)),
+        step_(full_step_) {
+    assert(min_size_ <= size_ && size_ <= max_size_);
+  }
+
+  size_t Size() const noexcept { return size_; }
+
+  // Returns the new size at the end of a period if it changed
+  std::optional<size_t> Record(bool hit) noexcept {
+    hits_ += hit;
+    if (++accesses_ < period_) return std::nullopt;
+
+    const double hit_ratio = static_cast<double>(hits_) / period_;
+    hits_ = accesses_ = 0;
+    const double change = hit_ratio - previous_hit_ratio_;
+    previous_hit_ratio_ = hit_ratio;
+
+    const double amount = change >= 0 ? step_ : -step_;
+    step_ = std::abs(change) >= kRestartThreshold
+                ? std::copysign(full_step_, amount)
+                : kStepDecay * amount;
+
+    const double target = std::clamp(
+        std::round(static_cast<double>(size_) + amount),
+        static_cast<double>(min_size_), static_cast<double>(max_size_));
+    const auto size = static_cast<size_t>(target);
+    if (size == size_) return std::nullopt;
+    size_ = size;
+    return size_;
+  }
+
+ private:
+  const size_t min_size_;
+  const size_t max_size_;
+  const size_t period_;
+  size_t size_;
+
+  const double full_step_;
+  // signed, the direction of the next move on a growing hit ratio
+  double step_;
+  double previous_hit_ratio_{0.0};
+
+  size_t accesses_{0};
+  size_t hits_{0};
+};
+
+}  // namespace cache
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+
+#include <cache_config.hpp>
+#include <simd.hpp>
+
+// Kernels searching a key in the records of a small page. Every kernel
+// returns the index of the key or SMALL_PAGE_SIZE if it's absent. The one
+// supported by the CPU is picked at startup, see `FindKeyIdxDispatched`.
+
+namespace cache {
+
+template <CacheKey TKey>
+inline size_t FindKeyIdx(
+    TKey key, const std::array<TKey, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto* it = std::find(records.begin(), records.end(), key);
+  return std::distance(records.begin(), it);
+}
+
+// ------ SSE4.2, 16 bytes per register ------ //
+
+CACHE_TARGET("sse4.2")
+inline size_t FindKeyIdxSSE42(
+    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm_set1_epi32(static_cast<int>(key));
+  const auto N = records.size();
+  static_assert(SMALL_PAGE_SIZE % 16 == 0);
+
+  for (size_t block_id = 0; block_id < N; block_id += 16) {
+    const auto* block = reinterpret_cast<const __m128i*>(&records[block_id]);
+    const auto m1 = _mm_cmpeq_epi32(x, _mm_load_si128(block));
+    const auto m2 = _mm_cmpeq_epi32(x, _mm_load_si128(block + 1));
+    const auto m3 = _mm_cmpeq_epi32(x, _mm_load_si128(block + 2));
+    const auto m4 = _mm_cmpeq_epi32(x, _mm_load_si128(block + 3));
+    const auto m = _mm_or_si128(_mm_or_si128(m1, m2), _mm_or_si128(m3, m4));
+    if (!_mm_testz_si128(m, m)) {
+      const auto mask = _mm_movemask_ps(_mm_castsi128_ps(m1)) |
+                        (_mm_movemask_ps(_mm_castsi128_ps(m2)) << 4) |
+                        (_mm_movemask_ps(_mm_castsi128_ps(m3)) << 8) |
+                        (_mm_movemask_ps(_mm_castsi128_ps(m4)) << 12);
+      return block_id + __builtin_ctz(mask);
+    }
+  }
+
+  return N;
+}
+
+CACHE_TARGET("sse4.2")
+inline size_t FindKeyIdxSSE42(
+    uint64_t key,
+    const std::array<uint64_t, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm_set1_epi64x(static_cast<int64_t>(key));
+  const auto N = records.size();
+  static_assert(SMALL_PAGE_SIZE % 8 == 0);
+
+  for (size_t block_id = 0; block_id < N; block_id += 8) {
+    const auto* block = reinterpret_cast<const __m128i*>(&records[block_id]);
+    const auto m1 = _mm_cmpeq_epi64(x, _mm_load_si128(block));
+    const auto m2 = _mm_cmpeq_epi64(x, _mm_load_si128(block + 1));
+    const auto m3 = _mm_cmpeq_epi64(x, _mm_load_si128(block + 2));
+    const auto m4 = _mm_cmpeq_epi64(x, _mm_load_si128(block + 3));
+    const auto m = _mm_or_si128(_mm_or_si128(m1, m2), _mm_or_si128(m3, m4));
+    if (!_mm_testz_si128(m, m)) {
+      const auto mask = _mm_movemask_pd(_mm_castsi128_pd(m1)) |
+                        (_mm_movemask_pd(_mm_castsi128_pd(m2)) << 2) |
+                        (_mm_movemask_pd(_mm_castsi128_pd(m3)) << 4) |
+                        (_mm_movemask_pd(_mm_castsi128_pd(m4)) << 6);
+      return block_id + __builtin_ctz(mask);
+    }
+  }
+
+  return N;
+}
+
+// ------ AVX2, 32 bytes per register ------ //
+
+CACHE_TARGET("avx2")
+inline size_t FindKeyIdxSIMD8(
+    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm256_set1_epi32(key);
+  // const auto x = _mm256_broadcastd_epi32(_mm_loadu_si32(&key));
+  const auto N = records.size();
+  assert(N % 8 == 0);
+
+  assert(reinterpret_cast<std::uintptr_t>(records.data()) % 32 == 0);
+  for (size_t block_id = 0; block_id < N; block_id += 8) {
+    const auto y =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(&records[block_id]));
+    const auto m = _mm256_cmpeq_epi32(x, y);
+    if (!_mm256_testz_si256(m, m)) {
+      const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+      return block_id + __builtin_ctz(mask);
+    }
+  }
+
+  return N;
+}
+
+CACHE_TARGET("avx2")
+inline size_t FindKeyIdxSIMD16(
+    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm256_set1_epi32(key);
+  const auto N = records.size();
+  assert(N % 8 == 0);
+
+  assert(reinterpret_cast<std::uintptr_t>(records.data()) % 32 == 0);
+  for (size_t block_id = 0; block_id < N; block_id += 16) {
+    const auto y1 =
+        _mm256_load_si256(reinterpret_cast<const __m256i*>(&records[block_id]));
+    const auto y2 = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(&records[block_id + 8]));
+    const auto m1 = _mm256_cmpeq_epi32(x, y1);
+    const auto m2 = _mm256_cmpeq_epi32(x, y2);
+    const auto m = _mm256_or_si256(m1, m2);
+    if (!_mm256_testz_si256(m, m)) {
+      const auto mask = (_mm256_movemask_ps(_mm256_castsi256_ps(m2)) << 8) +
+                        _mm256_movemask_ps(_mm256_castsi256_ps(m1));
+      return block_id + __builtin_ctz(mask);
+    }
+  }
+
+  return N;
+}
+
+// 64-bit keys, 4 keys per AVX2 register
+CACHE_TARGET("avx2")
+inline size_t FindKeyIdxSIMD16(
+    uint64_t key,
+    const std::array<uint64_t, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm256_set1_epi64x(static_cast<int64_t>(key));
+  const auto N = records.size();
+  assert(N % 16 == 0);
+
+  assert(reinterpret_cast<std::uintptr_t>(records.data()) % 32 == 0);
+  for (size_t block_id = 0; block_id < N; block_id += 16) {
+    const auto* block = reinterpret_cast<const __m256i*>(&records[block_id]);
+    const auto m1 = _mm256_cmpeq_epi64(x, _mm256_load_si256(block));
+    const auto m2 = _mm256_cmpeq_epi64(x, _mm256_load_si256(block + 1));
+    const auto m3 = _mm256_cmpeq_epi64(x, _mm256_load_si256(block + 2));
+    const auto m4 = _mm256_cmpeq_epi64(x, _mm256_load_si256(block + 3));
+    const auto m = _mm256_or_si256(_mm256_or_si256(m1, m2),
+                                   _mm256_or_si256(m3, m4));
+    if (!_mm256_testz_si256(m, m)) {
+      const auto mask = _mm256_movemask_pd(_mm256_castsi256_pd(m1)) |
+                        (_mm256_movemask_pd(_mm256_castsi256_pd(m2)) << 4) |
+                        (_mm256_movemask_pd(_mm256_castsi256_pd(m3)) << 8) |
+                        (_mm256_movemask_pd(_mm256_castsi256_pd(m4)) << 12);
+      return block_id + __builtin_ctz(mask);
+    }
+  }
+
+  return N;
+}
+
+// ------ AVX-512, 64 bytes per register ------ //
+
+CACHE_TARGET("avx512f")
+inline size_t FindKeyIdxAVX512(
+    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm512_set1_epi32(static_cast<int>(key));
+  const auto N = records.size();
+  static_assert(SMALL_PAGE_SIZE % 32 == 0);
+
+  for (size_t block_id = 0; block_id < N; block_id += 32) {
+    const auto* block = &records[block_id];
+    const __mmask16 m1 = _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(block));
+    const __mmask16 m2 =
+        _mm512_cmpeq_epi32_mask(x, _mm512_loadu_si512(block + 16));
+    const uint32_t mask = m1 | (static_cast<uint32_t>(m2) << 16);
+    if (mask != 0) return block_id + __builtin_ctz(mask);
+  }
+
+  return N;
+}
+
+CACHE_TARGET("avx512f")
+inline size_t FindKeyIdxAVX512(
+    uint64_t key,
+    const std::array<uint64_t, SMALL_PAGE_SIZE>& records) noexcept {
+  const auto x = _mm512_set1_epi64(static_cast<int64_t>(key));
+  const auto N = records.size();
+  static_assert(SMALL_PAGE_SIZE % 16 == 0);
+
+  for (size_t block_id = 0; block_id < N; block_id += 16) {
+    const auto* block = &records[block_id];
+    const __mmask8 m1 = _mm512_cmpeq_epi64_mask(x, _mm512_loadu_si512(block));
+    const __mmask8 m2 =
+        _mm512_cmpeq_epi64_mask(x, _mm512_loadu_si512(block + 8));
+    const uint32_t mask = m1 | (static_cast<uint32_t>(m2) << 8);
+    if (mask != 0) return block_id + __builtin_ctz(mask);
+  }
+
+  return N;
+}
+
+// ------ a bucket of a hashed small page ------ //
+
+// Searches `BucketSize` keys starting at `bucket` (aligned to 16 bytes).
+// SSE2 is a part of x86-64, so no dispatch is needed.
+template <size_t BucketSize, CacheKey TKey>
+  requires(BucketSize * sizeof(TKey) % 16 == 0 &&
+           BucketSize * sizeof(TKey) <= 256)
+inline size_t FindKeyIdxInBucket(TKey key, const TKey* bucket) noexcept {
+  constexpr size_t kLanesPerKey = sizeof(TKey) / 4;
+  const auto x = kLanesPerKey == 1
+                     ? _mm_set1_epi32(static_cast<int>(key))
+                     : _mm_set1_epi64x(static_cast<int64_t>(key));
+  assert(reinterpret_cast<std::uintptr_t>(bucket) % 16 == 0);
+
+  // a bit per 32-bit lane
+  uint64_t mask = 0;
+  const auto* block = reinterpret_cast<const __m128i*>(bucket);
+  for (size_t i = 0; i < BucketSize * sizeof(TKey) / 16; ++i) {
+    const auto m = _mm_cmpeq_epi32(x, _mm_load_si128(block + i));
+    mask |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(m)))
+            << (4 * i);
+  }
+  if constexpr (kLanesPerKey == 2) {
+    // both halves of a 64-bit key are equal
+    mask &= (mask >> 1) & 0x5555555555555555ull;
+  }
+  return mask != 0 ? __builtin_ctzll(mask) / kLanesPerKey : BucketSize;
+}
+
+// ------ runtime dispatch ------ //
+
+template <CacheKey TKey>
+using FindKeyIdxFn =
+    size_t (*)(TKey, const std::array<TKey, SMALL_PAGE_SIZE>&) noexcept;
+
+template <CacheKey TKey>
+FindKeyIdxFn<TKey> SelectFindKeyIdx(SimdLevel level) noexcept {
+  switch (level) {
+    case SimdLevel::kAVX512:
+      return &FindKeyIdxAVX512;
+    case SimdLevel::kAVX2:
+      return &FindKeyIdxSIMD16;
+    case SimdLevel::kSSE42:
+      return &FindKeyIdxSSE42;
+    case SimdLevel::kScalar:
+      break;
+  }
+  return &FindKeyIdx<TKey>;
+}
+
+// Searches with the widest kernel supported by the CPU
+template <CacheKey TKey>
+inline size_t FindKeyIdxDispatched(
+    TKey key, const std::array<TKey, SMALL_PAGE_SIZE>& records) noexcept {
+  static const FindKeyIdxFn<TKey> find = SelectFindKeyIdx<TKey>(kSimdLevel);
+  return find(key, records);
+}
+
+}  // namespace cache
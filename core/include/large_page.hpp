@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <vector>
 
 #include <cache_config.hpp>
 #include <small_page.hpp>
@@ -10,15 +11,21 @@
 
 namespace cache {
 
-inline size_t LargePageIndex(Key key) noexcept {
-  return key >> (8ull * sizeof(Key) - LARGE_PAGE_SHIFT);
+template <CacheKey TKey>
+inline size_t LargePageIndex(TKey key) noexcept {
+  return key >> (8ull * sizeof(TKey) - LARGE_PAGE_SHIFT);
 }
 
-class LargePage {
+template <CacheKey TKey = Key, class TValues = NoValues>
+class BasicLargePage {
  public:
-  explicit LargePage(TTinyLFU& tiny_lfu)
-      : small_pages_(utils::MakeArray<SMALL_PAGE_NUMBER>(SmallPage{tiny_lfu})) {
-  }
+  using KeyType = TKey;
+  using TSmallPage = BasicSmallPage<TKey, TValues>;
+  using Value = typename TSmallPage::Value;
+
+  explicit BasicLargePage(TBasicTinyLFU<TKey>& tiny_lfu)
+      : small_pages_(
+            utils::MakeArray<SMALL_PAGE_NUMBER>(TSmallPage{tiny_lfu})) {}
 
   void Clear() noexcept {
     for (auto& page : small_pages_) {
@@ -26,30 +33,49 @@ class LargePage {
     }
   }
 
+  // Applies the hits buffered by the small pages, they aren't stored. Called
+  // on the thread of the accesses before the page is stored.
+  void DrainReadBuffers() noexcept {
+    for (auto& page : small_pages_) {
+      page.DrainReadBuffer();
+    }
+  }
+
   void Load(std::ifstream& file) {
-    static std::array<char, kDataSizeInBytes> buff{};
-    file.read(buff.data(), kDataSizeInBytes);
+    char* buff = GetThreadBuffer();
+    file.read(buff, kDataSizeInBytes);
+    Load(buff);
+  }
 
+  void Store(std::ofstream& file) const {
+    char* buff = GetThreadBuffer();
+    Store(buff);
+    file.write(buff, kDataSizeInBytes);
+  }
+
+  // `buffer` must hold at least `kDataSizeInBytes` bytes
+  void Load(const char* buffer) noexcept {
     for (size_t i = 0; i < SMALL_PAGE_NUMBER; ++i) {
-      small_pages_[i].Load(buff.data() + i * SmallPage::kDataSizeInBytes);
+      small_pages_[i].Load(buffer + i * TSmallPage::kDataSizeInBytes);
     }
   }
 
-  void Store(std::ofstream& file) const {
-    static std::array<char, kDataSizeInBytes> buff{};
+  void Store(char* buffer) const noexcept {
     for (size_t i = 0; i < SMALL_PAGE_NUMBER; ++i) {
-      small_pages_[i].Store(buff.data() + i * SmallPage::kDataSizeInBytes);
+      small_pages_[i].Store(buffer + i * TSmallPage::kDataSizeInBytes);
     }
+  }
 
-    file.write(buff.data(), kDataSizeInBytes);
+  void Prefetch(TKey key) const noexcept {
+    small_pages_[SmallPageIndex(key)].Prefetch(key);
   }
 
-  bool Get(Key key, uint32_t now) noexcept {
-    return small_pages_[SmallPageIndex(key)].Get(key, now);
+  bool Get(TKey key, uint32_t now, Value* out = nullptr) {
+    return small_pages_[SmallPageIndex(key)].Get(key, now, out);
   }
 
-  void Update(Key key, uint32_t expiration_time) noexcept {
-    small_pages_[SmallPageIndex(key)].Update(key, expiration_time);
+  void Update(TKey key, uint32_t expiration_time, const Value& value = {}) {
+    small_pages_[SmallPageIndex(key)].Update(key, expiration_time, value);
   }
 
 #if ENABLE_STATISTICS_FLAG
@@ -79,18 +105,26 @@ class LargePage {
   }
 #endif
 
-  bool operator==(const LargePage& other) const noexcept {
+  bool operator==(const BasicLargePage& other) const noexcept {
     for (size_t i = 0; i < SMALL_PAGE_NUMBER; ++i) {
       if (small_pages_[i] != other.small_pages_[i]) return false;
     }
     return true;
   }
 
- private:
   static constexpr std::size_t kDataSizeInBytes =
-      SMALL_PAGE_NUMBER * SmallPage::kDataSizeInBytes;
+      SMALL_PAGE_NUMBER * TSmallPage::kDataSizeInBytes;
 
-  std::array<SmallPage, SMALL_PAGE_NUMBER> small_pages_;
+ private:
+  // pages are loaded/stored by the caller and the I/O threads concurrently
+  static char* GetThreadBuffer() {
+    thread_local std::vector<char> buff(kDataSizeInBytes);
+    return buff.data();
+  }
+
+  std::array<TSmallPage, SMALL_PAGE_NUMBER> small_pages_;
 };
 
+using LargePage = BasicLargePage<>;
+
 }  // namespace cache
@@ -1,59 +1,85 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <set>
+#include <stdexcept>
+#include <vector>
 
+#include <background_worker.hpp>
 #include <cache_config.hpp>
 #include <large_page.hpp>
+#include <large_page_store.hpp>
 
 namespace cache {
 
-class LargePageProvider {
+template <CacheKey TKey = Key, class TValues = NoValues>
+class BasicLargePageProvider {
  public:
-  LargePageProvider(std::filesystem::path dir_path, TTinyLFU& tiny_lfu)
-      : dir_path_(std::move(dir_path)),
-        storage_(std::make_unique<Storage>(tiny_lfu)) {
-    static_assert(LOADED_PAGE_NUMBER <= LARGE_PAGE_NUMBER);
+  using TLargePage = BasicLargePage<TKey, TValues>;
+
+  BasicLargePageProvider(std::filesystem::path dir_path,
+                         TBasicTinyLFU<TKey>& tiny_lfu,
+                         const CacheConfig& config = {})
+      : config_(Validate(config)),
+        dir_path_(dir_path),
+        store_(std::move(dir_path)),
+        storage_(std::make_unique<Storage>(config_.loaded_page_number,
+                                           tiny_lfu)),
+        loaded_frequencies_(config_.loaded_page_number) {
     static_assert(LARGE_PAGE_SHIFT + SMALL_PAGE_SHIFT + SMALL_PAGE_SIZE_SHIFT <=
-                  8 * sizeof(Key));
-    if (!std::filesystem::exists(dir_path_))
-      std::filesystem::create_directory(dir_path_);
+                  8 * sizeof(TKey));
 
     size_t storage_index = 0;
 
+    // best pages go first, so the warm-up loads the hottest pages first
     for (auto [_, page_index] : LoadHeader()) {
-      // TODO: сделать ленивую загрузку
       page_infos_[page_index].storage_index = storage_index;
       loaded_frequencies_[storage_index] =
           std::make_pair(page_infos_[page_index].frequency, page_index);
-      LoadPage(storage_index);
+      if (!config_.lazy_load) {
+        LoadPage(storage_index, page_index);
+        PublishSlot(storage_index);
+      } else if (config_.warm_up_lazy_pages) {
+        WarmUpPage(storage_index, page_index);
+      }
       ++storage_index;
     }
   }
 
+  // `count` is the number of accesses to the page, greater than one when the
+  // keys of a batch are grouped by the large page
   template <bool CalledOnUpdate>
-  LargePage* Get(Key key) {
-    if (time_ == LARGE_PAGE_PERIOD) {
+  TLargePage* Get(TKey key, size_t count = 1) {
+    if (time_ >= config_.large_page_period) {
       DivFrequency();
       time_ = 0;
     }
 
-    ++time_;
+    time_ += count;
 
     const size_t page_index = LargePageIndex(key);
-    page_infos_[page_index].frequency += 1;
-    if (auto page_ptr = GetLoadedPage(page_index); page_ptr) {
-      loaded_frequencies_[page_infos_[page_index].storage_index].first += 1;
-      return page_ptr;
+    page_infos_[page_index].frequency += count;
+    if (const size_t storage_index = page_infos_[page_index].storage_index;
+        storage_index != NPOS) {
+      loaded_frequencies_[storage_index].first += count;
+      if (auto page_ptr = GetLoadedPage(storage_index); page_ptr) {
+        return page_ptr;
+      }
+#if ENABLE_STATISTICS_FLAG
+      if (CalledOnUpdate) dropped_keys_ += count;
+#endif
+      return nullptr;  // the page is still being swapped in
     }
 
-    if (worst_frequency_estimation_ + FREQUENCY_THRESHOLD <
+    if (worst_frequency_estimation_ + config_.frequency_threshold <
         page_infos_[page_index].frequency) {
       // update estimation
 
       worst_frequency_estimation_ = std::numeric_limits<size_t>::max();
       size_t storage_index = NPOS;
-      for (size_t index = 0; index < LOADED_PAGE_NUMBER; ++index) {
+      for (size_t index = 0; index < loaded_frequencies_.size(); ++index) {
         if (loaded_frequencies_[index].first < worst_frequency_estimation_) {
           worst_frequency_estimation_ = loaded_frequencies_[index].first;
           storage_index = index;
@@ -65,43 +91,68 @@ class LargePageProvider {
       const size_t worst_page = loaded_frequencies_[storage_index].second;
       assert(page_infos_[worst_page].storage_index == storage_index);
 
-      if (worst_frequency_estimation_ + FREQUENCY_THRESHOLD <
+      if (worst_frequency_estimation_ + config_.frequency_threshold <
           page_infos_[page_index].frequency) {
-        StorePage(storage_index);
-
         page_infos_[page_index].storage_index = storage_index;
         page_infos_[worst_page].storage_index = NPOS;
 
         loaded_frequencies_[storage_index] =
             std::make_pair(page_infos_[page_index].frequency, page_index);
 
-        LoadPage(storage_index);
-
         // TODO update worst_loaded_page ?
 
+        if (config_.async_swap) {
+          SwapPageAsync(storage_index, worst_page, page_index);
+#if ENABLE_STATISTICS_FLAG
+          if (CalledOnUpdate) dropped_keys_ += count;
+#endif
+          return nullptr;
+        }
+
+        if (ClaimSlot(storage_index) == SlotState::kReady) {
+          storage_->large_pages[storage_index].DrainReadBuffers();
+          StorePage(storage_index, worst_page);
+        }
+        LoadPage(storage_index, page_index);
+        PublishSlot(storage_index);
+
         return &(storage_->large_pages[storage_index]);
       }
     }
 #if ENABLE_STATISTICS_FLAG
-    if (CalledOnUpdate) dropped_keys_++;
+    if (CalledOnUpdate) dropped_keys_ += count;
 #endif
 
     return nullptr;
   }
 
-  void Store() const {
+  // Not const: the buffered hits of the pages are applied before the store
+  void Store() {
+    WaitForPendingSwaps();
+
     StoreHeader();
-    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
-      StorePage(i);
+    for (size_t i = 0; i < loaded_frequencies_.size(); ++i) {
+      // a page which was never loaded is up to date on the disk
+      if (storage_->states[i].load(std::memory_order_acquire) ==
+          SlotState::kReady) {
+        storage_->large_pages[i].DrainReadBuffers();
+        StorePage(i, loaded_frequencies_[i].second);
+      }
     }
+    store_.Flush();
   }
 
+  // Blocks until all the background swaps and warm-ups are finished
+  void WaitForPendingSwaps() const { io_worker_.Wait(); }
+
 #if ENABLE_STATISTICS_FLAG
   size_t large_page_loads_{0};
   uint64_t dropped_keys_{0};
 #endif
 
-  ~LargePageProvider() {
+  ~BasicLargePageProvider() {
+    stopping_.store(true, std::memory_order_relaxed);  // skip the warm-up
+    WaitForPendingSwaps();
     if constexpr (ENABLE_STATISTICS_FLAG) PrintStatistics();
   }
 
@@ -111,17 +162,51 @@ class LargePageProvider {
     size_t storage_index{NPOS};
   };
 
+  enum class SlotState : uint8_t {
+    kUnloaded,  // the page is assigned to the slot but not read yet
+    kLoading,   // the slot is owned by the thread which reads the page
+    kReady,
+  };
+
   struct Storage {
-    explicit Storage(TTinyLFU& tiny_lfu)
-        : large_pages(
-              utils::MakeArray<LOADED_PAGE_NUMBER>(LargePage{tiny_lfu})) {}
+    Storage(size_t loaded_page_number, TBasicTinyLFU<TKey>& tiny_lfu)
+        : pending_swaps(loaded_page_number), states(loaded_page_number) {
+      large_pages.reserve(loaded_page_number);
+      for (size_t i = 0; i < loaded_page_number; ++i) {
+        large_pages.emplace_back(tiny_lfu);
+      }
+    }
 
-    std::array<LargePage, LOADED_PAGE_NUMBER> large_pages;
+    std::vector<TLargePage> large_pages;
+    // number of swaps of the slot queued to `io_worker_`, the slot may be
+    // accessed only when it is zero
+    std::vector<std::atomic<uint32_t>> pending_swaps;
+    std::vector<std::atomic<SlotState>> states;
   };
 
-  std::filesystem::path GetFilePath(size_t i) const {
-    return dir_path_ /
-           std::filesystem::path("page" + std::to_string(i) + ".bin");
+  static const CacheConfig& Validate(const CacheConfig& config) {
+    if (config.shard_index >= config.shard_number) {
+      throw std::invalid_argument(
+          "CacheConfig::shard_index must be less than shard_number");
+    }
+    const size_t page_number = OwnedPageNumber(config);
+    if (config.loaded_page_number == 0 ||
+        config.loaded_page_number > page_number) {
+      throw std::invalid_argument(
+          "CacheConfig::loaded_page_number must be in [1, " +
+          std::to_string(page_number) + "]");
+    }
+    return config;
+  }
+
+  // The number of the large pages of the keys of the shard
+  static size_t OwnedPageNumber(const CacheConfig& config) noexcept {
+    return (LARGE_PAGE_NUMBER - config.shard_index + config.shard_number - 1) /
+           config.shard_number;
+  }
+
+  bool IsOwned(size_t page_index) const noexcept {
+    return page_index % config_.shard_number == config_.shard_index;
   }
 
   std::filesystem::path GetHeaderPath() const {
@@ -139,21 +224,22 @@ class LargePageProvider {
       for (size_t i = 0; i < page_infos_.size(); ++i) {
         utils::BinaryRead(file, &page_infos_[i].frequency,
                           sizeof(page_infos_[i].frequency));
-        best_pages.emplace_back(page_infos_[i].frequency, i);
+        if (IsOwned(i)) best_pages.emplace_back(page_infos_[i].frequency, i);
       }
       std::sort(best_pages.begin(), best_pages.end(),
                 [](const auto& lhs, const auto& rhs) {
                   return lhs.first > rhs.first;
                 });
-      best_pages.resize(LOADED_PAGE_NUMBER);
+      best_pages.resize(config_.loaded_page_number);
     } else {
-      while (best_pages.size() < LOADED_PAGE_NUMBER) {
-        best_pages.emplace_back(0, best_pages.size());
+      while (best_pages.size() < config_.loaded_page_number) {
+        best_pages.emplace_back(0, config_.shard_index +
+                                       best_pages.size() * config_.shard_number);
       }
     }
 
     worst_frequency_estimation_ = best_pages.back().first;
-    assert(best_pages.size() == LOADED_PAGE_NUMBER);
+    assert(best_pages.size() == config_.loaded_page_number);
     return best_pages;
   }
 
@@ -165,37 +251,107 @@ class LargePageProvider {
     }
   }
 
-  LargePage* GetLoadedPage(size_t page_index) {
-    const size_t storage_index = page_infos_[page_index].storage_index;
-    return storage_index != NPOS ? &(storage_->large_pages[storage_index])
-                                 : nullptr;
+  TLargePage* GetLoadedPage(size_t storage_index) {
+    assert(storage_index != NPOS);
+    if (config_.async_swap) {
+      if (storage_->pending_swaps[storage_index].load(
+              std::memory_order_acquire) != 0)
+        return nullptr;
+    }
+    if (storage_->states[storage_index].load(std::memory_order_acquire) !=
+        SlotState::kReady) {
+      // lazy load on the first access
+      if (ClaimSlot(storage_index) == SlotState::kUnloaded)
+        LoadPage(storage_index, loaded_frequencies_[storage_index].second);
+      PublishSlot(storage_index);
+    }
+    return &(storage_->large_pages[storage_index]);
+  }
+
+  // Waits until the slot is not being loaded by another thread and takes its
+  // ownership (kLoading). Returns the state of the slot before the call:
+  // kUnloaded or kReady.
+  SlotState ClaimSlot(size_t storage_index) {
+    auto& state = storage_->states[storage_index];
+    auto expected = state.load(std::memory_order_acquire);
+    while (true) {
+      if (expected == SlotState::kLoading) {
+        state.wait(SlotState::kLoading, std::memory_order_acquire);
+        expected = state.load(std::memory_order_acquire);
+      } else if (state.compare_exchange_weak(expected, SlotState::kLoading,
+                                             std::memory_order_acquire)) {
+        return expected;
+      }
+    }
   }
 
-  void LoadPage(size_t storage_index) {
-    assert(storage_index != NPOS);
+  void PublishSlot(size_t storage_index) {
+    auto& state = storage_->states[storage_index];
+    state.store(SlotState::kReady, std::memory_order_release);
+    state.notify_all();
+  }
+
+  // Reads the page on `io_worker_` unless it's already read by the caller
+  void WarmUpPage(size_t storage_index, size_t page_index) {
+    io_worker_.Push([this, storage_index, page_index] {
+      if (stopping_.load(std::memory_order_relaxed)) return;
+
+      auto expected = SlotState::kUnloaded;
+      if (storage_->states[storage_index].compare_exchange_strong(
+              expected, SlotState::kLoading, std::memory_order_acquire)) {
+        ReadPage(storage_index, page_index);
+        PublishSlot(storage_index);
+      }
+    });
+  }
+
+  // Stores the victim and loads the new page on `io_worker_`. The slot is
+  // published via `pending_swaps` only after the load is finished, so the
+  // caller thread never observes a half-loaded page. Swaps of the same slot
+  // are serialized by the worker's FIFO order.
+  void SwapPageAsync(size_t storage_index, size_t victim_page,
+                     size_t page_index) {
+    // the buffered hits of the victim are applied on this thread; a page of
+    // a pending swap or a lazy load was never accessed, so it has none
+    if (storage_->pending_swaps[storage_index].load(
+            std::memory_order_acquire) == 0 &&
+        storage_->states[storage_index].load(std::memory_order_acquire) ==
+            SlotState::kReady) {
+      storage_->large_pages[storage_index].DrainReadBuffers();
+    }
+    storage_->pending_swaps[storage_index].fetch_add(1,
+                                                     std::memory_order_relaxed);
 #if ENABLE_STATISTICS_FLAG
     large_page_loads_++;
 #endif
-
-    const std::filesystem::path file_path =
-        GetFilePath(loaded_frequencies_[storage_index].second);
-    if (std::filesystem::exists(file_path)) {
-      std::ifstream file(file_path, std::ios_base::binary);
-      storage_->large_pages[storage_index].Load(
-          file);  // TODO: убрать копирование, при большом размере
-                  // stack-overflow
-    } else {
-      storage_->large_pages[storage_index].Clear();
-    }
+    io_worker_.Push([this, storage_index, victim_page, page_index] {
+      // the caller doesn't touch the slot while the swap is pending, and the
+      // warm-up runs on this thread, so the slot can't be kLoading here
+      auto& state = storage_->states[storage_index];
+      if (state.load(std::memory_order_acquire) == SlotState::kReady)
+        StorePage(storage_index, victim_page);
+      ReadPage(storage_index, page_index);
+      PublishSlot(storage_index);
+      storage_->pending_swaps[storage_index].fetch_sub(
+          1, std::memory_order_release);
+    });
   }
 
-  void StorePage(size_t storage_index) const {
+  void LoadPage(size_t storage_index, size_t page_index) {
     assert(storage_index != NPOS);
+#if ENABLE_STATISTICS_FLAG
+    large_page_loads_++;
+#endif
+    ReadPage(storage_index, page_index);
+  }
 
-    std::ofstream file(GetFilePath(loaded_frequencies_[storage_index].second),
-                       std::ios_base::binary | std::ios_base::trunc);
+  void ReadPage(size_t storage_index, size_t page_index) {
+    store_.Load(page_index, storage_->large_pages[storage_index]);
+  }
 
-    storage_->large_pages[storage_index].Store(file);
+  void StorePage(size_t storage_index, size_t page_index) const {
+    assert(storage_index != NPOS);
+    store_.Store(page_index, storage_->large_pages[storage_index]);
   }
 
   void DivFrequency() {  // делит все частоты на 2
@@ -203,8 +359,8 @@ class LargePageProvider {
       page_infos_[i].frequency >>= 1;
     }
     worst_frequency_estimation_ >>= 1;
-    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
-      loaded_frequencies_[i].first >>= 1;
+    for (auto& [frequency, _] : loaded_frequencies_) {
+      frequency >>= 1;
     }
   }
 
@@ -218,14 +374,14 @@ class LargePageProvider {
               << dropped_keys_ << std::endl;
 
     uint64_t evictions_high_freq = 0;
-    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    for (size_t i = 0; i < config_.loaded_page_number; ++i) {
       evictions_high_freq += storage_->large_pages[i].GetNumEvictionsHighFreq();
     }
     std::cout << "Кол-во вытесненных ключей из страницы (при переполнении): "
               << evictions_high_freq << std::endl;
 
     uint64_t dropped_keys_low_freq = 0;
-    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    for (size_t i = 0; i < config_.loaded_page_number; ++i) {
       dropped_keys_low_freq +=
           storage_->large_pages[i].GetNumDroppedKeysLowFreq();
     }
@@ -234,9 +390,9 @@ class LargePageProvider {
 
     std::vector<double> fill_factors;
     const size_t SMALL_PAGE_NUM_OVERALL =
-        LOADED_PAGE_NUMBER * SMALL_PAGE_NUMBER;
+        config_.loaded_page_number * SMALL_PAGE_NUMBER;
     fill_factors.reserve(SMALL_PAGE_NUM_OVERALL);
-    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    for (size_t i = 0; i < config_.loaded_page_number; ++i) {
       auto factors = storage_->large_pages[i].GetSmallPagesFillFactors();
       fill_factors.insert(fill_factors.end(), factors.begin(), factors.end());
     }
@@ -263,16 +419,23 @@ class LargePageProvider {
 
   static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
 
+  const CacheConfig config_;
   const std::string dir_path_;
+  TBasicLargePageStore<TLargePage> store_;
   std::unique_ptr<Storage> storage_;
   std::array<LargePageInfo, LARGE_PAGE_NUMBER> page_infos_;
   size_t worst_frequency_estimation_;  // частота загруженных страниц не меньше
                                        // этой оценки
-  std::array<std::pair<size_t, size_t>, LOADED_PAGE_NUMBER>
+  std::vector<std::pair<size_t, size_t>>
       loaded_frequencies_;  // <частота, индекс page_infos_> в дубликат частот
                             // страниц для быстрого обновления
                             // worst_frequency_estimation_
   size_t time_{0};
+
+  std::atomic<bool> stopping_{false};
+  mutable BackgroundWorker io_worker_;
 };
 
+using LargePageProvider = BasicLargePageProvider<>;
+
 }  // namespace cache
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <cache_config.hpp>
+#include <large_page.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace cache {
+
+namespace details {
+
+constexpr size_t kOsPageSize = 4096;
+
+constexpr size_t AlignToOsPage(size_t size) noexcept {
+  return (size + kOsPageSize - 1) / kOsPageSize * kOsPageSize;
+}
+
+}  // namespace details
+
+// Disk representation of the large pages. Both stores are safe to use from
+// different threads as long as they don't access the same page concurrently.
+
+// One `pageN.bin` file per large page
+template <class TLargePage>
+class BasicLargePageFileStore final {
+ public:
+  explicit BasicLargePageFileStore(std::filesystem::path dir_path)
+      : dir_path_(std::move(dir_path)) {
+    if (!std::filesystem::exists(dir_path_))
+      std::filesystem::create_directory(dir_path_);
+  }
+
+  // Clears the page if it has never been stored
+  void Load(size_t page_index, TLargePage& page) const {
+    const std::filesystem::path file_path = GetFilePath(page_index);
+    if (std::filesystem::exists(file_path)) {
+      std::ifstream file(file_path, std::ios_base::binary);
+      page.Load(file);
+    } else {
+      page.Clear();
+    }
+  }
+
+  void Store(size_t page_index, const TLargePage& page) const {
+    std::ofstream file(GetFilePath(page_index),
+                       std::ios_base::binary | std::ios_base::trunc);
+    page.Store(file);
+  }
+
+  void Flush() const noexcept {}
+
+ private:
+  std::filesystem::path GetFilePath(size_t i) const {
+    return dir_path_ /
+           std::filesystem::path("page" + std::to_string(i) + ".bin");
+  }
+
+  const std::filesystem::path dir_path_;
+};
+
+// All the large pages live in a single `pages.bin` file which is mapped into
+// memory once, so a swap is a memcpy from/to the page cache without any
+// open/read/close syscalls. Layout:
+// [header: the layout of the pages][directory: 1 byte per page, 1 if the page
+// was ever stored][page 0][page 1]..
+// Every region is aligned to the OS page size. The file is sparse: pages
+// which were never stored don't occupy disk space. A file written with
+// another layout (key width, values, page geometry) is rejected.
+template <class TLargePage>
+class BasicLargePageMmapStore final {
+ public:
+  explicit BasicLargePageMmapStore(std::filesystem::path dir_path) {
+    if (!std::filesystem::exists(dir_path))
+      std::filesystem::create_directory(dir_path);
+
+    const auto file_path = dir_path / "pages.bin";
+    fd_ = ::open(file_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ == -1) ThrowSystemError("Can't open " + file_path.string());
+
+    // a file with a zero header was resized but the header wasn't written:
+    // no page was stored into it yet
+    const auto file_size = std::filesystem::file_size(file_path);
+    Header header{};
+    if (file_size != 0 &&
+        (file_size != kFileSize ||
+         ::pread(fd_, &header, sizeof(header), 0) != sizeof(header))) {
+      CloseAndThrowInvalid(file_path);
+    }
+    if (IsZero(header)) {
+      // the header is on the disk before any page is stored
+      if (::ftruncate(fd_, static_cast<off_t>(kFileSize)) == -1 ||
+          ::pwrite(fd_, &kHeader, sizeof(kHeader), 0) != sizeof(kHeader) ||
+          ::fdatasync(fd_) == -1) {
+        CloseAndThrow("Can't initialize " + file_path.string());
+      }
+    } else if (std::memcmp(&header, &kHeader, sizeof(header)) != 0) {
+      CloseAndThrowInvalid(file_path);
+    }
+
+    void* data = ::mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) CloseAndThrow("Can't mmap " + file_path.string());
+    data_ = static_cast<char*>(data);
+  }
+
+  BasicLargePageMmapStore(BasicLargePageMmapStore&&) = delete;
+  BasicLargePageMmapStore(const BasicLargePageMmapStore&) = delete;
+
+  BasicLargePageMmapStore& operator=(BasicLargePageMmapStore&&) = delete;
+  BasicLargePageMmapStore& operator=(const BasicLargePageMmapStore&) = delete;
+
+  ~BasicLargePageMmapStore() {
+    ::munmap(data_, kFileSize);
+    ::close(fd_);
+  }
+
+  // Clears the page if it has never been stored
+  void Load(size_t page_index, TLargePage& page) const noexcept {
+    if (Directory()[page_index] == 0) {
+      page.Clear();
+      return;
+    }
+
+    char* region = GetRegion(page_index);
+    ::madvise(region, kRegionSize, MADV_WILLNEED);
+    page.Load(region);
+  }
+
+  void Store(size_t page_index, const TLargePage& page) const noexcept {
+    char* region = GetRegion(page_index);
+    page.Store(region);
+    Directory()[page_index] = 1;
+    if constexpr (MMAP_STORE_RELEASE_PAGES) {
+      // dirty pages stay in the page cache and are written back by the kernel
+      ::madvise(region, kRegionSize, MADV_DONTNEED);
+    }
+  }
+
+  // Writes all the stored pages to the disk
+  void Flush() const {
+    if (::msync(data_, kFileSize, MS_SYNC) == -1)
+      ThrowSystemError("Can't msync large pages");
+  }
+
+ private:
+  struct Header {
+    uint64_t magic;
+    uint64_t page_size;
+    uint64_t key_size;
+    uint64_t large_page_number;
+    uint64_t small_page_number;
+    uint64_t small_page_size;
+  };
+
+  static constexpr Header kHeader{0x3130454741504C43ull,  // "CLPAGE01"
+                                  TLargePage::kDataSizeInBytes,
+                                  sizeof(typename TLargePage::KeyType),
+                                  LARGE_PAGE_NUMBER,
+                                  SMALL_PAGE_NUMBER,
+                                  SMALL_PAGE_SIZE};
+
+  static constexpr size_t kHeaderSize = details::AlignToOsPage(sizeof(Header));
+  static constexpr size_t kDirectorySize =
+      details::AlignToOsPage(LARGE_PAGE_NUMBER);
+  static constexpr size_t kRegionSize =
+      details::AlignToOsPage(TLargePage::kDataSizeInBytes);
+  static constexpr size_t kFileSize =
+      kHeaderSize + kDirectorySize + LARGE_PAGE_NUMBER * kRegionSize;
+
+  [[noreturn]] static void ThrowSystemError(const std::string& what) {
+    throw std::system_error(errno, std::generic_category(), what);
+  }
+
+  [[noreturn]] void CloseAndThrow(const std::string& what) const {
+    const int error = errno;
+    ::close(fd_);
+    throw std::system_error(error, std::generic_category(), what);
+  }
+
+  [[noreturn]] void CloseAndThrowInvalid(
+      const std::filesystem::path& file_path) const {
+    ::close(fd_);
+    throw std::invalid_argument(file_path.string() +
+                                " holds pages of another layout");
+  }
+
+  static bool IsZero(const Header& header) noexcept {
+    constexpr Header kZero{};
+    return std::memcmp(&header, &kZero, sizeof(header)) == 0;
+  }
+
+  char* Directory() const noexcept { return data_ + kHeaderSize; }
+
+  char* GetRegion(size_t page_index) const noexcept {
+    return data_ + kHeaderSize + kDirectorySize + page_index * kRegionSize;
+  }
+
+  int fd_{-1};
+  char* data_{nullptr};
+};
+
+using LargePageFileStore = BasicLargePageFileStore<LargePage>;
+using LargePageMmapStore = BasicLargePageMmapStore<LargePage>;
+
+template <class TLargePage>
+using TBasicLargePageStore =
+    std::conditional_t<USE_MMAP_STORE, BasicLargePageMmapStore<TLargePage>,
+                       BasicLargePageFileStore<TLargePage>>;
+
+using TLargePageStore = TBasicLargePageStore<LargePage>;
+
+}  // namespace cache
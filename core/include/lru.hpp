@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <limits>
 #include <random>
 
 #include <cache_config.hpp>
+#include <small_page_values.hpp>
 
 #include <boost/intrusive/link_mode.hpp>
 #include <boost/intrusive/list.hpp>
@@ -12,6 +16,7 @@
 #include <boost/intrusive/unordered_set_hook.hpp>
 
 #include <optional>
+#include <vector>
 
 // Based on:
 // https://github.com/apolukhin/apolukhin.github.io/blob/master/presentations/C%2B%2B%20Faster.cpp
@@ -32,17 +37,20 @@ using ListBaseHook = boost::intrusive::list_base_hook<LinkMode>;
 using UnorderedSetBaseHook =
     boost::intrusive::unordered_set_base_hook<LinkMode>;
 
-template <class Key>
+template <class Key, class Value>
 struct Node final : public ListBaseHook, public UnorderedSetBaseHook {
-  explicit Node(Key key, uint32_t expiration_time)
-      : key(std::move(key)), expiration_time(expiration_time) {}
+  explicit Node(Key key, uint32_t expiration_time, Value value)
+      : key(std::move(key)),
+        expiration_time(expiration_time),
+        value(std::move(value)) {}
 
   Key key;
   uint32_t expiration_time;
+  [[no_unique_address]] Value value;
 };
 
-template <class SomeKey>
-const SomeKey& GetKey(const Node<SomeKey>& node) noexcept {
+template <class SomeKey, class Value>
+const SomeKey& GetKey(const Node<SomeKey, Value>& node) noexcept {
   return node.key;
 }
 
@@ -51,15 +59,39 @@ const T& GetKey(const T& key) noexcept {
   return key;
 }
 
+// Whether a hit of a record expiring at `expiration_time` evicts it instead
+inline bool ShouldEvict(uint32_t expiration_time, uint32_t now) {
+  if constexpr (TTL_EVICTION_PROB > 0.0) {
+    thread_local std::mt19937 gen(BERNOULLI_SEED ? BERNOULLI_SEED
+                                           : std::random_device{}());
+    thread_local std::bernoulli_distribution dist(TTL_EVICTION_PROB);
+    return dist(gen);
+  } else {
+    return expiration_time < now;
+  }
+}
+
 }  // namespace details
 
 template <class Key, class Hash = std::hash<Key>,
-          class Equal = std::equal_to<Key>>
+          class Equal = std::equal_to<Key>, class Value = NoValue>
 class LRU final {
  public:
+  struct Entry {
+    Key key;
+    uint32_t expiration_time;
+    Value value;
+  };
+
+  // `max_size` is also the capacity: the largest size of `SetMaxSize`
   explicit LRU(size_t max_size)
       : buckets_(max_size ? max_size : 1),
-        map_(BucketTraits(buckets_.data(), buckets_.size())) {}
+        map_(BucketTraits(buckets_.data(), buckets_.size())),
+        max_size_(buckets_.size()) {
+    assert(buckets_.size() <= std::numeric_limits<uint32_t>::max());
+    // the nodes never move, they are constructed in place on the first use
+    nodes_.reserve(buckets_.size());
+  }
 
   LRU(LRU&& lru) = delete;
   LRU(const LRU& lru) = delete;
@@ -68,76 +100,109 @@ class LRU final {
   LRU& operator=(const LRU& lru) = delete;
 
   ~LRU() {
-    while (!list_.empty()) {
-      ExtractNode(list_.begin());
-    }
+    // unlinks the nodes before they are destroyed
+    map_.clear();
+    list_.clear();
   }
 
   std::optional<Key> Update(Key key, uint32_t expiration_time) {
-    std::optional<Key> evicted_key;
+    auto evicted = UpdateEntry(std::move(key), expiration_time, Value{});
+    if (!evicted) return std::nullopt;
+    return std::move(evicted->key);
+  }
+
+  // Returns the evicted entry (if any) to be passed to the next cache level
+  std::optional<Entry> UpdateEntry(Key key, uint32_t expiration_time,
+                                   Value value) {
     auto it = map_.find(key, map_.hash_function(), map_.key_eq());
     if (it != map_.end()) {
+      it->expiration_time = expiration_time;
+      it->value = std::move(value);
       list_.splice(list_.end(), list_, list_.iterator_to(*it));
       return std::nullopt;
     }
 
-    if (map_.size() == buckets_.size()) {
-      auto node = ExtractNode(list_.begin());
-      evicted_key = node->key;
-      node->key = key;
-      node->expiration_time = expiration_time;
-      InsertNode(std::move(node));
+    std::optional<Entry> evicted;
+    if (map_.size() >= max_size_) {
+      auto& node = ExtractNode(list_.begin());
+      evicted.emplace(Entry{std::move(node.key), node.expiration_time,
+                            std::move(node.value)});
+      node.key = std::move(key);
+      node.expiration_time = expiration_time;
+      node.value = std::move(value);
+      InsertNode(node);
+    } else if (!free_nodes_.empty()) {
+      auto& node = nodes_[free_nodes_.back()];
+      free_nodes_.pop_back();
+      node.key = std::move(key);
+      node.expiration_time = expiration_time;
+      node.value = std::move(value);
+      InsertNode(node);
     } else {
-      auto node = std::make_unique<LruNode>(key, expiration_time);
-      InsertNode(std::move(node));
+      InsertNode(nodes_.emplace_back(std::move(key), expiration_time,
+                                     std::move(value)));
     }
 
-    return evicted_key;
+    return evicted;
+  }
+
+  size_t MaxSize() const noexcept { return max_size_; }
+
+  // A shrink doesn't evict by itself, the entries beyond `max_size` are
+  // taken by `EvictExcess`
+  void SetMaxSize(size_t max_size) noexcept {
+    assert(max_size <= buckets_.size());
+    max_size_ = max_size ? max_size : 1;
   }
 
-  bool Get(Key key, uint32_t now) {
+  // Evicts the least recently used entry if the size exceeds the max one
+  std::optional<Entry> EvictExcess() {
+    if (map_.size() <= max_size_) return std::nullopt;
+
+    auto& node = ExtractNode(list_.begin());
+    free_nodes_.push_back(static_cast<uint32_t>(&node - nodes_.data()));
+    return Entry{std::move(node.key), node.expiration_time,
+                 std::move(node.value)};
+  }
+
+  // Prefetches the bucket of the key to hide the cache miss of a following
+  // Get/Update
+  void Prefetch(const Key& key) const noexcept {
+    __builtin_prefetch(&buckets_[map_.bucket(key, map_.hash_function())]);
+  }
+
+  // `out` (if any) receives the value of the key on a hit
+  bool Get(Key key, uint32_t now, Value* out = nullptr) {
     auto it = map_.find(key, map_.hash_function(), map_.key_eq());
     if (it == map_.end()) return false;
 
-    bool should_evict = false;
-    if constexpr (TTL_EVICTION_PROB > 0.0) {
-      static std::mt19937 gen(BERNOULLI_SEED ? BERNOULLI_SEED
-                                             : std::random_device{}());
-      static std::bernoulli_distribution dist(TTL_EVICTION_PROB);
-      should_evict = dist(gen);
-    } else {
-      should_evict = it->expiration_time < now;
-    }
-
-    if (should_evict) {
-      ExtractNode(list_.iterator_to(*it));
+    if (details::ShouldEvict(it->expiration_time, now)) {
+      auto& node = ExtractNode(list_.iterator_to(*it));
+      free_nodes_.push_back(static_cast<uint32_t>(&node - nodes_.data()));
       return false;
     }
 
+    if (out != nullptr) *out = it->value;
     list_.splice(list_.end(), list_, list_.iterator_to(*it));
     return true;
   }
 
  private:
-  using LruNode = details::Node<Key>;
+  using LruNode = details::Node<Key, Value>;
   using List =
       boost::intrusive::list<LruNode,
                              boost::intrusive::constant_time_size<false>>;
 
-  std::unique_ptr<LruNode> ExtractNode(typename List::iterator it) noexcept {
-    std::unique_ptr<LruNode> ret(&*it);
-    map_.erase(map_.iterator_to(*it));
+  LruNode& ExtractNode(typename List::iterator it) noexcept {
+    auto& node = *it;
+    map_.erase(map_.iterator_to(node));
     list_.erase(it);
-    return ret;
+    return node;
   }
 
-  void InsertNode(std::unique_ptr<LruNode>&& node) noexcept {
-    if (!node) return;
-
-    map_.insert(*node);
-    list_.insert(list_.end(), *node);
-
-    node.release();
+  void InsertNode(LruNode& node) noexcept {
+    map_.insert(node);
+    list_.insert(list_.end(), node);
   }
 
   struct LruNodeHash : Hash {
@@ -162,9 +227,15 @@ class LRU final {
   using BucketType = typename Map::bucket_type;
 
  private:
+  // A single allocation of the capacity of nodes, the unlinked ones (expired
+  // before the LRU got full) are reused by their index
+  std::vector<LruNode> nodes_;
+  std::vector<uint32_t> free_nodes_;
+
   std::vector<BucketType> buckets_;
   Map map_;
   List list_;
+  size_t max_size_;
 };
 
 }  // namespace cache
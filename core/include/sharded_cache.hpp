@@ -0,0 +1,108 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <cache.hpp>
+
+namespace cache {
+
+// Thread-safe front-end over independent `Cache` shards. Keys are
+// partitioned by their large page, so every large page (and its swaps)
+// belongs to exactly one shard. Each shard has its own provider, LRU and
+// TinyLFU guarded by its own mutex, so threads contend only when they hit
+// the same shard.
+// The loaded pages and the LRU of `config` are the budget of the whole cache:
+// they are split across the shards, so the memory doesn't grow with the
+// number of shards.
+template <CacheKey TKey = Key, class TValues = NoValues>
+class BasicShardedCache final {
+ public:
+  using Value = typename TValues::Value;
+
+  // Enough shards for a few threads, every one more splits the budget finer
+  static constexpr size_t kDefaultShardsNumber = 4;
+
+  explicit BasicShardedCache(size_t num_shards = kDefaultShardsNumber,
+                             const std::filesystem::path& dir_path = "./data",
+                             const CacheConfig& config = {}) {
+    if (num_shards == 0 || num_shards > config.loaded_page_number) {
+      throw std::invalid_argument(
+          "the number of shards must be in [1, loaded_page_number]");
+    }
+    if (!std::filesystem::exists(dir_path))
+      std::filesystem::create_directory(dir_path);
+
+    shards_.reserve(num_shards);
+    for (size_t i = 0; i < num_shards; ++i) {
+      shards_.push_back(std::make_unique<Shard>(
+          dir_path / std::filesystem::path("shard" + std::to_string(i)),
+          ShardConfig(config, i, num_shards)));
+    }
+  }
+
+  bool Get(TKey key, uint32_t now, Value* out = nullptr) {
+    auto& shard = GetShard(key);
+    std::lock_guard lock(shard.mutex);
+    return shard.cache.Get(key, now, out);
+  }
+
+  void Update(TKey key, uint32_t expiration_time, const Value& value = {}) {
+    auto& shard = GetShard(key);
+    std::lock_guard lock(shard.mutex);
+    shard.cache.Update(key, expiration_time, value);
+  }
+
+  void Store() {
+    for (auto& shard : shards_) {
+      std::lock_guard lock(shard->mutex);
+      shard->cache.Store();
+    }
+  }
+
+  size_t GetShardsNumber() const noexcept { return shards_.size(); }
+
+ private:
+  // aligned to avoid false sharing of the mutexes
+  struct alignas(64) Shard {
+    Shard(std::filesystem::path dir_path, const CacheConfig& config)
+        : cache(std::move(dir_path), config) {}
+
+    mutable std::mutex mutex;
+    BasicCache<TKey, TValues> cache;
+  };
+
+  // The part of `config` of the shard `index`: the first shards take the
+  // remainders
+  static CacheConfig ShardConfig(const CacheConfig& config, size_t index,
+                                 size_t num_shards) noexcept {
+    auto split = [&](size_t total) {
+      return total / num_shards + (index < total % num_shards ? 1 : 0);
+    };
+    CacheConfig shard_config = config;
+    shard_config.shard_index = index;
+    shard_config.shard_number = num_shards;
+    shard_config.loaded_page_number = split(config.loaded_page_number);
+    shard_config.lru_size = split(config.lru_size);
+    shard_config.min_lru_size = split(config.min_lru_size);
+    shard_config.max_lru_size = split(config.max_lru_size);
+    // a shard sees a part of the accesses
+    shard_config.lru_climb_period = split(config.lru_climb_period);
+    return shard_config;
+  }
+
+  Shard& GetShard(TKey key) noexcept {
+    return *shards_[LargePageIndex(key) % shards_.size()];
+  }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+using ShardedCache = BasicShardedCache<>;
+using ShardedCache64 = BasicShardedCache<uint64_t>;
+
+}  // namespace cache
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <immintrin.h>
+
+// The binary doesn't require any SIMD extension: a kernel is compiled for its
+// instruction set via the target attribute, and the one supported by the CPU
+// is picked at runtime by `kSimdLevel`.
+
+#define CACHE_TARGET(isa) __attribute__((target(isa)))
+
+namespace cache {
+
+enum class SimdLevel { kScalar, kSSE42, kAVX2, kAVX512 };
+
+inline SimdLevel DetectSimdLevel() noexcept {
+  // may run before the constructors of the runtime
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) return SimdLevel::kAVX512;
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::kAVX2;
+  if (__builtin_cpu_supports("sse4.2")) return SimdLevel::kSSE42;
+  return SimdLevel::kScalar;
+}
+
+inline const char* ToString(SimdLevel level) noexcept {
+  switch (level) {
+    case SimdLevel::kScalar:
+      return "scalar";
+    case SimdLevel::kSSE42:
+      return "SSE4.2";
+    case SimdLevel::kAVX2:
+      return "AVX2";
+    case SimdLevel::kAVX512:
+      return "AVX-512";
+  }
+  return "unknown";
+}
+
+// The level of the CPU the process runs on, detected once at startup
+inline const SimdLevel kSimdLevel = DetectSimdLevel();
+
+}  // namespace cache
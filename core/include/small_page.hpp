@@ -1,15 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+
 #include <cache_config.hpp>
+#include <key_search.hpp>
+#include <small_page_filter.hpp>
+#include <small_page_values.hpp>
 #include <tiny_lfu_cms.hpp>
 #include <utils.hpp>
 
-#include <immintrin.h>
-
 namespace cache {
 
-inline size_t SmallPageIndex(Key key) noexcept {
-  key &= (1ull << (8ull * sizeof(Key) - LARGE_PAGE_SHIFT)) - 1ull;
+template <CacheKey TKey>
+inline size_t SmallPageIndex(TKey key) noexcept {
+  key &= (TKey{1} << (8ull * sizeof(TKey) - LARGE_PAGE_SHIFT)) - 1ull;
   return key % SMALL_PAGE_NUMBER;
 }
 
@@ -18,65 +27,18 @@ inline size_t SmallPageIndex(Key key) noexcept {
 //     return key >> (8ull * sizeof(Key) - LARGE_PAGE_SHIFT - SMALL_PAGE_SHIFT);
 // }
 
-inline size_t FindKeyIdxSIMD8(
-    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
-  const auto x = _mm256_set1_epi32(key);
-  // const auto x = _mm256_broadcastd_epi32(_mm_loadu_si32(&key));
-  const auto N = records.size();
-  assert(N % 8 == 0);
-
-  assert(reinterpret_cast<std::uintptr_t>(records.data()) % 32 == 0);
-  for (size_t block_id = 0; block_id < N; block_id += 8) {
-    const auto y =
-        _mm256_load_si256(reinterpret_cast<const __m256i*>(&records[block_id]));
-    const auto m = _mm256_cmpeq_epi32(x, y);
-    if (!_mm256_testz_si256(m, m)) {
-      const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
-      return block_id + __builtin_ctz(mask);
-    }
-  }
-
-  return N;
-}
-
-inline size_t FindKeyIdxSIMD16(
-    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
-  const auto x = _mm256_set1_epi32(key);
-  const auto N = records.size();
-  assert(N % 8 == 0);
-
-  assert(reinterpret_cast<std::uintptr_t>(records.data()) % 32 == 0);
-  for (size_t block_id = 0; block_id < N; block_id += 16) {
-    const auto y1 =
-        _mm256_load_si256(reinterpret_cast<const __m256i*>(&records[block_id]));
-    const auto y2 = _mm256_load_si256(
-        reinterpret_cast<const __m256i*>(&records[block_id + 8]));
-    const auto m1 = _mm256_cmpeq_epi32(x, y1);
-    const auto m2 = _mm256_cmpeq_epi32(x, y2);
-    const auto m = _mm256_or_si256(m1, m2);
-    if (!_mm256_testz_si256(m, m)) {
-      const auto mask = (_mm256_movemask_ps(_mm256_castsi256_ps(m2)) << 8) +
-                        _mm256_movemask_ps(_mm256_castsi256_ps(m1));
-      return block_id + __builtin_ctz(mask);
-    }
-  }
-
-  return N;
-}
-
-inline size_t FindKeyIdx(
-    Key key, const std::array<Key, SMALL_PAGE_SIZE>& records) noexcept {
-  const auto* it = std::find(records.begin(), records.end(), key);
-  return std::distance(records.begin(), it);
-}
-
-class SmallPageAdvanced {
+// `TValues` is the storage of the values, see small_page_values.hpp
+template <CacheKey TKey = Key, class TValues = NoValues,
+          SmallPageOrdering Ordering = SMALL_PAGE_ORDERING>
+class BasicSmallPage {
  public:
+  using Value = typename TValues::Value;
+
   struct Payload {
     uint32_t expiration_time;
   };
 
-  explicit SmallPageAdvanced(TTinyLFU& tiny_lfu) noexcept
+  explicit BasicSmallPage(TBasicTinyLFU<TKey>& tiny_lfu) noexcept
       : tiny_lfu_(tiny_lfu) {
     Clear();
   }
@@ -85,7 +47,7 @@ class SmallPageAdvanced {
   double GetFillFactor() const {
     uint32_t cnt = 0;
     for (const auto& r : records_) {
-      if (r != INVALID_HASH) {
+      if (r != INVALID_KEY<TKey>) {
         ++cnt;
       }
     }
@@ -97,93 +59,163 @@ class SmallPageAdvanced {
 #endif
 
   void Clear() noexcept {
-    records_.fill(INVALID_HASH);
+    records_.fill(INVALID_KEY<TKey>);
     payload_.fill(Payload{0});
+    frequencies_.fill(0);
+    // the page may be cleared on the I/O worker, so it doesn't read the
+    // sketch: the epoch is taken by the next `AgeFrequencies`
+    frequencies_epoch_ = kUnsetEpoch;
+    values_.Clear();
+    bloom_filter_.Clear();
     last_free_slot_ = 0;
+    read_buffer_size_ = 0;
   }
 
   void Load(const char* buffer) noexcept {
-#if USE_BF_FLAG
-    bloom_filter_.Load(file);
-#endif
-
+    read_buffer_size_ = 0;
     utils::LoadArrayFromBuffer(buffer, records_);
     std::advance(buffer, records_.size() * sizeof(records_[0]));
     utils::LoadArrayFromBuffer(buffer, payload_);
     std::advance(buffer, payload_.size() * sizeof(payload_[0]));
     utils::BinaryRead(buffer, &last_free_slot_, sizeof(last_free_slot_));
-    std::advance(buffer, sizeof(size_t));
+    std::advance(buffer, sizeof(last_free_slot_));
+    utils::LoadArrayFromBuffer(buffer, frequencies_);
+    std::advance(buffer, frequencies_.size());
+    utils::BinaryRead(buffer, &frequencies_epoch_, sizeof(frequencies_epoch_));
+    std::advance(buffer, sizeof(frequencies_epoch_));
+    bloom_filter_.Load(buffer);
+    std::advance(buffer, decltype(bloom_filter_)::kDataSizeInBytes);
+    values_.Load(buffer);
   }
 
-  void Store(char* buffer) const noexcept {
-#if USE_BF_FLAG
-    bloom_filter_.Store(file);
-#endif
+  // Applies the buffered hits. Raising a record moves only the records above
+  // it, so the hits are raised from the top: the slots of the next ones stay
+  // valid.
+  void DrainReadBuffer() noexcept {
+    if constexpr (kReadBufferSize > 0) {
+      if (read_buffer_size_ == 0) return;
+      const auto hits = std::span(read_buffer_.data(), read_buffer_size_);
+      read_buffer_size_ = 0;
+      // the misses of the sketch overlap
+      for (auto i : hits) tiny_lfu_.Prefetch(records_[i]);
+      for (auto i : hits) Touch(i, records_[i]);
+      if constexpr (kOrdered) {
+        std::sort(hits.begin(), hits.end());
+        const auto last = std::unique(hits.begin(), hits.end());
+        std::for_each(hits.begin(), last, [this](size_t i) { Raise(i); });
+      }
+    }
+  }
 
+  // The buffered hits are not stored: the owner drains them before the store
+  void Store(char* buffer) const noexcept {
     utils::StoreArrayToBuffer(buffer, records_);
     std::advance(buffer, records_.size() * sizeof(records_[0]));
     utils::StoreArrayToBuffer(buffer, payload_);
     std::advance(buffer, payload_.size() * sizeof(payload_[0]));
     utils::BinaryWrite(buffer, &last_free_slot_, sizeof(last_free_slot_));
-    std::advance(buffer, sizeof(size_t));
+    std::advance(buffer, sizeof(last_free_slot_));
+    utils::StoreArrayToBuffer(buffer, frequencies_);
+    std::advance(buffer, frequencies_.size());
+    utils::BinaryWrite(buffer, &frequencies_epoch_,
+                       sizeof(frequencies_epoch_));
+    std::advance(buffer, sizeof(frequencies_epoch_));
+    bloom_filter_.Store(buffer);
+    std::advance(buffer, decltype(bloom_filter_)::kDataSizeInBytes);
+    values_.Store(buffer);
   }
 
-  bool Get(Key key, uint32_t now) noexcept {
-#if USE_BF_FLAG
-    if (!bloom_filter_.Test(key)) {
-      return false;
+  // Prefetches the head of the records, where the most frequent keys are (so
+  // the search for a hit usually stops there), and the eviction victim. A
+  // hashed page prefetches only the bucket of the key.
+  void Prefetch(TKey key) const noexcept {
+    constexpr size_t kKeysPerCacheLine = 64 / sizeof(TKey);
+    if constexpr (kHashed) {
+      const size_t first = GroupOf<kBucketSize>(key);
+      for (size_t i = 0; i < kBucketSize; i += kKeysPerCacheLine) {
+        __builtin_prefetch(&records_[first + i]);
+      }
+      return;
     }
-#endif
+    for (size_t i = 0; i < kPrefetchCacheLines; ++i) {
+      __builtin_prefetch(&records_[i * kKeysPerCacheLine]);
+    }
+    __builtin_prefetch(&records_.back());
+  }
 
-#if USE_SIMD_FLAG
-    const auto i = FindKeyIdxSIMD16(key, records_);
-#else
-    const auto i = FindKeyIdx(key, records_);
-#endif
+  // `out` (if any) receives the value of the key on a hit
+  bool Get(TKey key, uint32_t now, Value* out = nullptr) noexcept(kNoThrow) {
+    if (!bloom_filter_.MayContain(key)) return false;
+
+    const auto i = FindKey(key);
     if (i < records_.size()) {
       if (CheckEvictedByTTL(i, now)) return false;
-      tiny_lfu_.Add(key);
-      Raise(i);
+      values_.Get(i, out);
+      OnHit(i, key);
       return true;
     }
     return false;
   }
 
-  bool Update(Key key, uint32_t expiration_time) noexcept {
-    if (records_.back() == INVALID_HASH) {
-      assert(last_free_slot_ < records_.size());
-      assert(records_[last_free_slot_] == INVALID_HASH);
+  // Returns false if the key is not admitted (or its value doesn't fit)
+  bool Update(TKey key, uint32_t expiration_time,
+              const Value& value = {}) noexcept(kNoThrow) {
+    DrainReadBuffer();
+    if constexpr (kHasValues) {
+      // the value of a cached key is overwritten instead of being duplicated
+      const auto i =
+          bloom_filter_.MayContain(key) ? FindKey(key) : records_.size();
+      if (i < records_.size()) {
+        if (!values_.Set(i, value)) {
+          Remove(i);
+          return false;
+        }
+        payload_[i].expiration_time = expiration_time;
+        Touch(i, key);
+        OnAccess(i);
+        return true;
+      }
+    }
 
-      records_[last_free_slot_] = key;
-      payload_[last_free_slot_].expiration_time = expiration_time;
-      tiny_lfu_.Add(key);
+    const size_t free_slot = FindFreeSlot(key);
+    if (free_slot < records_.size()) {
+      assert(records_[free_slot] == INVALID_KEY<TKey>);
 
-#if USE_BF_FLAG
+      if (!values_.Set(free_slot, value)) return false;
+      records_[free_slot] = key;
+      payload_[free_slot].expiration_time = expiration_time;
+      Touch(free_slot, key);
       bloom_filter_.Add(key);
-#endif
 
-      Raise(last_free_slot_);
-      last_free_slot_++;
+      OnAccess(free_slot);
+      if constexpr (!kHashed) last_free_slot_++;
       return true;
     }
 
-    auto victim = records_.back();
-
-    auto est_victim = tiny_lfu_.Estimate(victim);
-    auto est_key = tiny_lfu_.Estimate(key);
+    AgeFrequencies();
+    const size_t victim_idx = FindVictim(key);
+    // the admission is decided by the fresh estimations: the cached ones only
+    // order the records and may lag behind the sketch
+    const auto est_victim = tiny_lfu_.Estimate(records_[victim_idx]);
+    const auto est_key = tiny_lfu_.Estimate(key);
     if (est_victim < est_key) {
-      records_.back() = key;
-      tiny_lfu_.Add(key);
+      if (!values_.Set(victim_idx, value)) {
+        // the value of the victim may be already overwritten
+        Remove(victim_idx);
+        return false;
+      }
+      records_[victim_idx] = key;
+      payload_[victim_idx].expiration_time = expiration_time;
+      Touch(victim_idx, key);
 
 #if ENABLE_STATISTICS_FLAG
       num_evictions_high_freq_ += (est_victim != 0);
 #endif
 
-#if USE_BF_FLAG
       bloom_filter_.Add(key);
-#endif
+      bloom_filter_.OnRemove(records_);  // the victim
 
-      Raise(records_.size() - 1);
+      OnAccess(victim_idx);
       return true;
     }
 #if ENABLE_STATISTICS_FLAG
@@ -192,25 +224,162 @@ class SmallPageAdvanced {
     return false;
   }
 
-  bool operator==(const SmallPageAdvanced& other) const noexcept {
-    return records_ == other.records_;
+  bool operator==(const BasicSmallPage& other) const noexcept {
+    return records_ == other.records_ && values_ == other.values_;
   }
 
  private:
-  void Raise(
-      size_t i) noexcept {  // поднимает запись i в соответствии с частотой
-    while (i > 0 && tiny_lfu_.Estimate(records_[i - 1]) <
-                        tiny_lfu_.Estimate(records_[i])) {
-      std::swap(records_[i - 1], records_[i]);
-      std::swap(payload_[i - 1], payload_[i]);
-      --i;
+  static constexpr bool kHasValues = !std::is_same_v<TValues, NoValues>;
+  static constexpr bool kNoThrow =
+      std::is_nothrow_copy_assignable_v<Value> || !kHasValues;
+
+  size_t FindKey(TKey key) const noexcept {
+    if constexpr (kHashed) {
+      const size_t first = GroupOf<kBucketSize>(key);
+      const size_t i =
+          FindKeyIdxInBucket<kBucketSize>(key, records_.data() + first);
+      return i < kBucketSize ? first + i : records_.size();
     }
+#if USE_SIMD_FLAG
+    return FindKeyIdxDispatched(key, records_);
+#else
+    return FindKeyIdx(key, records_);
+#endif
+  }
+
+  // Returns a free slot for the key or `records_.size()` if there is none
+  size_t FindFreeSlot(TKey key) const noexcept {
+    if constexpr (kHashed) {
+      const size_t first = GroupOf<kBucketSize>(key);
+      const size_t i = FindKeyIdxInBucket<kBucketSize>(INVALID_KEY<TKey>,
+                                                       records_.data() + first);
+      return i < kBucketSize ? first + i : records_.size();
+    } else {
+      if (records_.back() != INVALID_KEY<TKey>) return records_.size();
+      assert(last_free_slot_ < records_.size());
+      return last_free_slot_;
+    }
+  }
+
+  // The first slot of the group of `GroupSize` adjacent slots picked by the
+  // hash of the key: the slots of a group share the cache lines
+  template <size_t GroupSize>
+  static size_t GroupOf(TKey key) noexcept {
+    static_assert(SMALL_PAGE_SIZE % GroupSize == 0);
+    const auto hash = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) % (SMALL_PAGE_SIZE / GroupSize) * GroupSize;
+  }
+
+  static constexpr bool kOrdered = Ordering == SmallPageOrdering::kRaise;
+  static constexpr bool kHashed = Ordering == SmallPageOrdering::kHashed;
+  static constexpr size_t kBucketSize = SMALL_PAGE_BUCKET_SIZE;
+
+  void OnAccess(size_t i) noexcept {
+    if constexpr (kOrdered) Raise(i);
+  }
+
+  static constexpr size_t kReadBufferSize = SMALL_PAGE_READ_BUFFER_SIZE;
+
+  // Buffers the hit of the record `i`: the records don't move until the
+  // buffer is drained
+  void OnHit(size_t i, TKey key) noexcept {
+    if constexpr (kReadBufferSize == 0) {
+      Touch(i, key);
+      OnAccess(i);
+    } else {
+      read_buffer_[read_buffer_size_++] = static_cast<uint16_t>(i);
+      if (read_buffer_size_ == kReadBufferSize) DrainReadBuffer();
+    }
+  }
+
+  // Counts the access of the key in slot `i` and caches its new estimation
+  void Touch(size_t i, TKey key) noexcept {
+    tiny_lfu_.Add(key);
+    AgeFrequencies();  // the access may reset the sketch
+    // the wide counters of the sketch saturate the cached estimation
+    frequencies_[i] = static_cast<uint8_t>(
+        std::min<size_t>(tiny_lfu_.Estimate(key), UINT8_MAX));
+  }
+
+  // Halves the cached estimations as many times as the sketch was reset
+  // since they were cached, so they stay comparable with the sketch. The
+  // estimations of a page stored before a restart (the epoch is ahead, the
+  // sketch is empty) are zeroed as well.
+  void AgeFrequencies() noexcept {
+    const uint32_t epoch = tiny_lfu_.GetResetCount();
+    if (epoch == frequencies_epoch_) return;
+    if (frequencies_epoch_ == kUnsetEpoch) {
+      // the estimations of a cleared page are zeros
+      frequencies_epoch_ = epoch;
+      return;
+    }
+    const uint32_t shift = std::min(epoch - frequencies_epoch_, 8U);
+    for (auto& frequency : frequencies_) frequency >>= shift;
+    frequencies_epoch_ = epoch;
+  }
+
+  // Returns the index of the eviction victim of a full page
+  size_t FindVictim(TKey key) const noexcept {
+    if constexpr (kOrdered) {
+      return records_.size() - 1;
+    } else {
+      constexpr size_t kCandidates =
+          kHashed ? kBucketSize : SAMPLED_VICTIM_CANDIDATES;
+      const size_t first = GroupOf<kCandidates>(key);
+
+      size_t victim = first;
+      for (size_t i = first + 1; i < first + kCandidates; ++i) {
+        if (frequencies_[i] < frequencies_[victim]) victim = i;
+      }
+      return victim;
+    }
+  }
+
+  void Remove(size_t i) noexcept {
+    values_.Erase(i);
+    if constexpr (kOrdered) {
+      records_[i] = INVALID_KEY<TKey>;
+      SiftDown(i);
+    } else if constexpr (kHashed) {
+      // the slot belongs to the bucket of the key
+      records_[i] = INVALID_KEY<TKey>;
+    } else {
+      // the order doesn't matter, the last record fills the hole
+      const size_t last = --last_free_slot_;
+      if (i != last) {
+        records_[i] = records_[last];
+        payload_[i] = payload_[last];
+        frequencies_[i] = frequencies_[last];
+        values_.Swap(i, last);
+      }
+      records_[last] = INVALID_KEY<TKey>;
+    }
+    bloom_filter_.OnRemove(records_);
+  }
+
+  // Raises record i according to its frequency: the destination is found by
+  // a scan of the cached frequencies, then the records in between are moved
+  // down at once
+  void Raise(size_t i) noexcept {
+    size_t first = i;
+    while (first > 0 && frequencies_[first - 1] < frequencies_[i]) --first;
+    if (first == i) return;
+
+    std::rotate(records_.begin() + first, records_.begin() + i,
+                records_.begin() + i + 1);
+    std::rotate(payload_.begin() + first, payload_.begin() + i,
+                payload_.begin() + i + 1);
+    std::rotate(frequencies_.begin() + first, frequencies_.begin() + i,
+                frequencies_.begin() + i + 1);
+    values_.Rotate(first, i);
   }
 
   void SiftDown(size_t i) noexcept {
-    while (i + 1 < SMALL_PAGE_SIZE && records_[i + 1] != INVALID_HASH) {
+    while (i + 1 < SMALL_PAGE_SIZE && records_[i + 1] != INVALID_KEY<TKey>) {
       std::swap(records_[i], records_[i + 1]);
       std::swap(payload_[i], payload_[i + 1]);
+      std::swap(frequencies_[i], frequencies_[i + 1]);
+      values_.Swap(i, i + 1);
       ++i;
     }
     last_free_slot_--;
@@ -220,17 +389,25 @@ class SmallPageAdvanced {
   bool CheckEvictedByTTL(size_t idx, uint32_t now) {
     bool should_evict = false;
     if constexpr (cache::TTL_EVICTION_PROB > 0.0) {
-      static std::mt19937 gen(BERNOULLI_SEED ? BERNOULLI_SEED
+      thread_local std::mt19937 gen(BERNOULLI_SEED ? BERNOULLI_SEED
                                              : std::random_device{}());
-      static std::bernoulli_distribution dist(cache::TTL_EVICTION_PROB);
+      thread_local std::bernoulli_distribution dist(cache::TTL_EVICTION_PROB);
       should_evict = dist(gen);
     } else {
       should_evict = payload_[idx].expiration_time < now;
     }
 
     if (should_evict) {
-      records_[idx] = INVALID_HASH;
-      SiftDown(idx);
+      // the removal may move the records of the buffered hits, and the hits
+      // may move the expired record
+      if constexpr (kOrdered && kReadBufferSize > 0) {
+        const auto key = records_[idx];
+        DrainReadBuffer();
+        idx = FindKey(key);
+      } else {
+        DrainReadBuffer();
+      }
+      Remove(idx);
       return true;
     }
 
@@ -238,50 +415,39 @@ class SmallPageAdvanced {
   }
 
  private:
-  alignas(32) std::array<Key, SMALL_PAGE_SIZE> records_{};
+  static constexpr size_t kPrefetchCacheLines = 4;
+
+  // a hashed page stores the buckets in whole cache lines
+  alignas(64) std::array<TKey, SMALL_PAGE_SIZE> records_{};
   std::array<Payload, SMALL_PAGE_SIZE> payload_{};
 
+  // cached estimations of the records, the ordering reads them instead of
+  // hashing into the sketch
+  std::array<uint8_t, SMALL_PAGE_SIZE> frequencies_{};
+  // `GetResetCount` of the cached estimations
+  static constexpr uint32_t kUnsetEpoch = std::numeric_limits<uint32_t>::max();
+  uint32_t frequencies_epoch_{kUnsetEpoch};
+
   uint16_t last_free_slot_{0};
   static_assert((1ull << sizeof(last_free_slot_) * 8) >= SMALL_PAGE_SIZE);
 
-  TTinyLFU& tiny_lfu_;
+  TValues values_;
+
+  SmallPageBloomFilter<TKey, USE_BF> bloom_filter_;
+
+  // slots of the hits not applied yet
+  std::array<uint16_t, kReadBufferSize> read_buffer_{};
+  uint8_t read_buffer_size_{0};
+  static_assert(kReadBufferSize <= UINT8_MAX);
+
+  TBasicTinyLFU<TKey>& tiny_lfu_;
 
  public:
-  static constexpr size_t kDataSizeInBytes = SMALL_PAGE_SIZE * sizeof(Key) +
-                                             SMALL_PAGE_SIZE * sizeof(Payload) +
-                                             sizeof(last_free_slot_);
-
-#if USE_BF_FLAG
-  BloomFilter<Key, SMALL_PAGE_SIZE * 6> bloom_filter_{
-      [](Key key) { return static_cast<size_t>(key) * 2654435761 % 2 ^ 32; },
-      [](Key key) {
-        key += ~(key << 15);
-        key ^= (key >> 10);
-        key += (key << 3);
-        key ^= (key >> 6);
-        key += ~(key << 11);
-        key ^= (key >> 16);
-        return static_cast<size_t>(key);
-      },
-      [](Key key) {
-        int c2 = 0x27d4eb2d;
-        key = (key ^ 61) ^ (key >> 16);
-        key = key + (key << 3);
-        key = key ^ (key >> 4);
-        key = key * c2;
-        key = key ^ (key >> 15);
-        return static_cast<size_t>(key);
-      },
-      [](Key key) {
-        key = (key + 0x7ed55d16) + (key << 12);
-        key = (key ^ 0xc761c23c) ^ (key >> 19);
-        key = (key + 0x165667b1) + (key << 5);
-        key = (key + 0xd3a2646c) ^ (key << 9);
-        key = (key + 0xfd7046c5) + (key << 3);
-        key = (key ^ 0xb55a4f09) ^ (key >> 16);
-        return static_cast<size_t>(key);
-      }};
-#endif
+  static constexpr size_t kDataSizeInBytes =
+      SMALL_PAGE_SIZE * sizeof(TKey) + SMALL_PAGE_SIZE * sizeof(Payload) +
+      sizeof(last_free_slot_) + SMALL_PAGE_SIZE * sizeof(uint8_t) +
+      sizeof(uint32_t) + decltype(bloom_filter_)::kDataSizeInBytes +
+      TValues::kDataSizeInBytes;
 
 #if ENABLE_STATISTICS_FLAG
   uint64_t num_evictions_high_freq_{0};
@@ -289,6 +455,7 @@ class SmallPageAdvanced {
 #endif
 };
 
+using SmallPageAdvanced = BasicSmallPage<>;
 using SmallPage = SmallPageAdvanced;
 
 }  // namespace cache
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <bloom_filter.hpp>
+#include <cache_config.hpp>
+#include <utils.hpp>
+
+namespace cache {
+
+template <CacheKey TKey, bool Enabled>
+class SmallPageBloomFilter;
+
+// Lets the absent keys of a small page skip the search: a key which is not in
+// the filter is not in the page. A Bloom filter can't delete, so the removed
+// keys stay in it until it's rebuilt from the records once kMaxStaleKeys keys
+// were removed: the stale keys only add false positives.
+template <CacheKey TKey>
+class SmallPageBloomFilter<TKey, true> final {
+  using TFilter = BlockedBloomFilter<SMALL_PAGE_SIZE>;
+
+ public:
+  static constexpr size_t kMaxStaleKeys = SMALL_PAGE_SIZE / 8;
+  static constexpr size_t kDataSizeInBytes =
+      TFilter::kDataSizeInBytes + sizeof(uint32_t);
+
+  bool MayContain(TKey key) const noexcept { return filter_.Test(key); }
+
+  void Add(TKey key) noexcept { filter_.Add(key); }
+
+  // `records` are the records of the page after the removal
+  void OnRemove(const std::array<TKey, SMALL_PAGE_SIZE>& records) noexcept {
+    if (++stale_keys_ < kMaxStaleKeys) return;
+
+    filter_.Clear();
+    for (auto key : records) {
+      if (key != INVALID_KEY<TKey>) Add(key);
+    }
+    stale_keys_ = 0;
+  }
+
+  void Clear() noexcept {
+    filter_.Clear();
+    stale_keys_ = 0;
+  }
+
+  void Load(const char* buffer) noexcept {
+    filter_.Load(buffer);
+    std::advance(buffer, TFilter::kDataSizeInBytes);
+    utils::BinaryRead(buffer, &stale_keys_, sizeof(stale_keys_));
+  }
+
+  void Store(char* buffer) const noexcept {
+    filter_.Store(buffer);
+    std::advance(buffer, TFilter::kDataSizeInBytes);
+    utils::BinaryWrite(buffer, &stale_keys_, sizeof(stale_keys_));
+  }
+
+  bool operator==(const SmallPageBloomFilter&) const noexcept = default;
+
+ private:
+  TFilter filter_;
+  uint32_t stale_keys_{0};
+};
+
+// Every key may be in the page
+template <CacheKey TKey>
+class SmallPageBloomFilter<TKey, false> final {
+ public:
+  static constexpr size_t kDataSizeInBytes = 0;
+
+  bool MayContain(TKey /*key*/) const noexcept { return true; }
+  void Add(TKey /*key*/) noexcept {}
+  void OnRemove(const std::array<TKey, SMALL_PAGE_SIZE>& /*records*/) noexcept {
+  }
+  void Clear() noexcept {}
+
+  void Load(const char* /*buffer*/) noexcept {}
+  void Store(char* /*buffer*/) const noexcept {}
+
+  bool operator==(const SmallPageBloomFilter&) const noexcept = default;
+};
+
+}  // namespace cache
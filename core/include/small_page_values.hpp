@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <cache_config.hpp>
+#include <utils.hpp>
+
+// Storages of the values of a small page. A storage keeps a value per record
+// slot and follows the record when it's moved between slots.
+
+namespace cache {
+
+// The cache answers only whether the key is cached
+struct NoValue {
+  bool operator==(const NoValue&) const noexcept = default;
+};
+
+class NoValues final {
+ public:
+  using Value = NoValue;
+
+  static constexpr size_t kDataSizeInBytes = 0;
+
+  bool Set(size_t /*slot*/, const Value& /*value*/) noexcept { return true; }
+  void Get(size_t /*slot*/, Value* /*out*/) const noexcept {}
+  void Swap(size_t /*i*/, size_t /*j*/) noexcept {}
+  void Rotate(size_t /*first*/, size_t /*last*/) noexcept {}
+  void Erase(size_t /*slot*/) noexcept {}
+  void Clear() noexcept {}
+
+  void Load(const char* /*buffer*/) noexcept {}
+  void Store(char* /*buffer*/) const noexcept {}
+
+  bool operator==(const NoValues&) const noexcept = default;
+};
+
+// Fixed-size values stored in an array parallel to the records
+template <class T>
+  requires(std::is_trivially_copyable_v<T> &&
+           std::is_default_constructible_v<T>)
+class FixedValues final {
+ public:
+  using Value = T;
+
+  static constexpr size_t kDataSizeInBytes = SMALL_PAGE_SIZE * sizeof(T);
+
+  bool Set(size_t slot, const Value& value) noexcept {
+    values_[slot] = value;
+    return true;
+  }
+
+  void Get(size_t slot, Value* out) const noexcept {
+    if (out != nullptr) *out = values_[slot];
+  }
+
+  void Swap(size_t i, size_t j) noexcept { std::swap(values_[i], values_[j]); }
+
+  // Moves the value of `last` to `first`, the values of [first, last) are
+  // moved to the next slots
+  void Rotate(size_t first, size_t last) noexcept {
+    std::rotate(values_.begin() + first, values_.begin() + last,
+                values_.begin() + last + 1);
+  }
+
+  void Erase(size_t /*slot*/) noexcept {}
+
+  void Clear() noexcept { values_.fill(T{}); }
+
+  void Load(const char* buffer) noexcept {
+    utils::BinaryRead(buffer, values_.data(), kDataSizeInBytes);
+  }
+
+  void Store(char* buffer) const noexcept {
+    utils::BinaryWrite(buffer, values_.data(), kDataSizeInBytes);
+  }
+
+  bool operator==(const FixedValues& other) const noexcept {
+    return std::memcmp(values_.data(), other.values_.data(),
+                       kDataSizeInBytes) == 0;
+  }
+
+ private:
+  alignas(64) std::array<T, SMALL_PAGE_SIZE> values_{};
+};
+
+// Variable-size values stored out of line in a slab of `SlabSize` bytes per
+// small page. Values are appended to the slab, the space of the erased ones
+// is reclaimed by compaction when the slab is full. A value which doesn't fit
+// into the slab is not stored (`Set` returns false).
+template <size_t SlabSize>
+  requires(SlabSize <= std::numeric_limits<uint32_t>::max())
+class SlabValues final {
+  struct Ref {
+    uint32_t offset{0};
+    uint32_t size{0};
+  };
+
+ public:
+  using Value = std::string;
+
+  static constexpr size_t kDataSizeInBytes =
+      SMALL_PAGE_SIZE * sizeof(Ref) + sizeof(uint32_t) + SlabSize;
+
+  SlabValues() { Clear(); }
+
+  bool Set(size_t slot, std::string_view value) {
+    Erase(slot);
+    if (used_ + value.size() > SlabSize) {
+      Compact();
+      if (used_ + value.size() > SlabSize) return false;
+    }
+
+    std::memcpy(slab_.data() + used_, value.data(), value.size());
+    refs_[slot] = Ref{used_, static_cast<uint32_t>(value.size())};
+    used_ += value.size();
+    return true;
+  }
+
+  void Get(size_t slot, Value* out) const {
+    if (out != nullptr)
+      out->assign(slab_.data() + refs_[slot].offset, refs_[slot].size);
+  }
+
+  void Swap(size_t i, size_t j) noexcept { std::swap(refs_[i], refs_[j]); }
+
+  void Rotate(size_t first, size_t last) noexcept {
+    std::rotate(refs_.begin() + first, refs_.begin() + last,
+                refs_.begin() + last + 1);
+  }
+
+  // The space is reclaimed on the next compaction
+  void Erase(size_t slot) noexcept { refs_[slot] = Ref{}; }
+
+  void Clear() noexcept {
+    refs_.fill(Ref{});
+    used_ = 0;
+  }
+
+  void Load(const char* buffer) noexcept {
+    utils::LoadArrayFromBuffer(buffer, refs_);
+    std::advance(buffer, refs_.size() * sizeof(refs_[0]));
+    utils::BinaryRead(buffer, &used_, sizeof(used_));
+    std::advance(buffer, sizeof(used_));
+    utils::BinaryRead(buffer, slab_.data(), used_);
+  }
+
+  void Store(char* buffer) const noexcept {
+    utils::StoreArrayToBuffer(buffer, refs_);
+    std::advance(buffer, refs_.size() * sizeof(refs_[0]));
+    utils::BinaryWrite(buffer, &used_, sizeof(used_));
+    std::advance(buffer, sizeof(used_));
+    utils::BinaryWrite(buffer, slab_.data(), used_);
+  }
+
+  bool operator==(const SlabValues& other) const noexcept {
+    for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+      if (GetView(i) != other.GetView(i)) return false;
+    }
+    return true;
+  }
+
+ private:
+  std::string_view GetView(size_t slot) const noexcept {
+    return {slab_.data() + refs_[slot].offset, refs_[slot].size};
+  }
+
+  // Moves the live values to the beginning of the slab
+  void Compact() {
+    thread_local std::vector<char> buffer(SlabSize);
+    uint32_t used = 0;
+    for (auto& ref : refs_) {
+      if (ref.size == 0) continue;
+      std::memcpy(buffer.data() + used, slab_.data() + ref.offset, ref.size);
+      ref.offset = used;
+      used += ref.size;
+    }
+    std::memcpy(slab_.data(), buffer.data(), used);
+    used_ = used;
+  }
+
+  std::array<Ref, SMALL_PAGE_SIZE> refs_;
+  uint32_t used_{0};
+  std::array<char, SlabSize> slab_;
+};
+
+}  // namespace cache
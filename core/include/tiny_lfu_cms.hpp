@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
@@ -11,14 +13,24 @@
 
 namespace cache {
 
-template <class T, size_t SampleSize, size_t NumCounters, bool UseDoorKeeper>
+// `TSketch` is a CountMinSketch or a BlockedCountMinSketch of NumCounters.
+// The sketch is aged (halved) every SampleSize additions. With AgingSlices > 1
+// a slice of the sketch is halved every SampleSize / AgingSlices additions
+// instead, so no addition pays for halving the whole sketch. The estimations
+// are aged (see `GetResetCount`) once all the slices are halved.
+template <class T, size_t SampleSize, size_t NumCounters, bool UseDoorKeeper,
+          class TSketch = CountMinSketch<NumCounters>, size_t AgingSlices = 1>
+  requires(AgingSlices > 0)
 class TinyLFU;
 
-template <class T, size_t SampleSize, size_t NumCounters>
-class TinyLFU<T, SampleSize, NumCounters, false> final {
+template <class T, size_t SampleSize, size_t NumCounters, class TSketch,
+          size_t AgingSlices>
+class TinyLFU<T, SampleSize, NumCounters, false, TSketch, AgingSlices> final {
  public:
   using TGlobalCounter = uint32_t;
   static_assert(SampleSize <= std::numeric_limits<TGlobalCounter>::max());
+  static constexpr size_t kAgingPeriod =
+      std::max<size_t>(1, SampleSize / AgingSlices);
 
   void Add(T key) noexcept {
     if (key == std::numeric_limits<T>::max()) return;
@@ -26,7 +38,7 @@ class TinyLFU<T, SampleSize, NumCounters, false> final {
     sketch_.Add(key);
 
     if constexpr (SampleSize > 0) {
-      if (++global_counter_ >= SampleSize) Reset();
+      if (++global_counter_ >= kAgingPeriod) Age();
     }
   }
 
@@ -37,36 +49,69 @@ class TinyLFU<T, SampleSize, NumCounters, false> final {
     return frequency;
   }
 
+  // Prefetches the counters of the key in the sketch
+  void Prefetch(T key) const noexcept { sketch_.Prefetch(key); }
+
   void Load(std::ifstream& file) {
     utils::BinaryRead(file, &global_counter_, sizeof(global_counter_));
+    if constexpr (AgingSlices > 1) {
+      utils::BinaryRead(file, &aged_slices_, sizeof(aged_slices_));
+    }
     sketch_.Load(file);
   }
 
   void Store(std::ofstream& file) const {
     utils::BinaryWrite(file, &global_counter_, sizeof(global_counter_));
+    if constexpr (AgingSlices > 1) {
+      utils::BinaryWrite(file, &aged_slices_, sizeof(aged_slices_));
+    }
     sketch_.Store(file);
   }
 
   void Reset() noexcept {
     sketch_.Reset();
     global_counter_ = 0;
+    aged_slices_ = 0;
+    ++reset_count_;
   }
 
+  // Lets the users caching the estimations age them as the sketch is aged
+  uint32_t GetResetCount() const noexcept { return reset_count_; }
+
   void Clear() noexcept {
     sketch_.Clear();
     global_counter_ = 0;
+    aged_slices_ = 0;
   }
 
  private:
-  CountMinSketch<NumCounters> sketch_;
+  void Age() noexcept {
+    if constexpr (AgingSlices == 1) {
+      Reset();
+    } else {
+      sketch_.ResetSlice(aged_slices_, AgingSlices);
+      global_counter_ = 0;
+      if (++aged_slices_ == AgingSlices) {
+        aged_slices_ = 0;
+        ++reset_count_;
+      }
+    }
+  }
+
+  TSketch sketch_;
   TGlobalCounter global_counter_{0};
+  uint32_t aged_slices_{0};
+  uint32_t reset_count_{0};
 };
 
-template <class T, size_t SampleSize, size_t NumCounters>
-class TinyLFU<T, SampleSize, NumCounters, true> final {
+template <class T, size_t SampleSize, size_t NumCounters, class TSketch,
+          size_t AgingSlices>
+class TinyLFU<T, SampleSize, NumCounters, true, TSketch, AgingSlices> final {
  public:
   using TGlobalCounter = uint32_t;
   static_assert(SampleSize <= std::numeric_limits<TGlobalCounter>::max());
+  static constexpr size_t kAgingPeriod =
+      std::max<size_t>(1, SampleSize / AgingSlices);
 
   void Add(T key) noexcept {
     if (key == std::numeric_limits<T>::max()) return;
@@ -77,7 +122,7 @@ class TinyLFU<T, SampleSize, NumCounters, true> final {
     }
 
     if constexpr (SampleSize > 0) {
-      if (++global_counter_ >= SampleSize) Reset();
+      if (++global_counter_ >= kAgingPeriod) Age();
     }
   }
 
@@ -89,14 +134,23 @@ class TinyLFU<T, SampleSize, NumCounters, true> final {
     return frequency;
   }
 
+  // Prefetches the counters of the key in the sketch
+  void Prefetch(T key) const noexcept { sketch_.Prefetch(key); }
+
   void Load(std::ifstream& file) {
     utils::BinaryRead(file, &global_counter_, sizeof(global_counter_));
+    if constexpr (AgingSlices > 1) {
+      utils::BinaryRead(file, &aged_slices_, sizeof(aged_slices_));
+    }
     door_keeper_.Load(file);
     sketch_.Load(file);
   }
 
   void Store(std::ofstream& file) const {
     utils::BinaryWrite(file, &global_counter_, sizeof(global_counter_));
+    if constexpr (AgingSlices > 1) {
+      utils::BinaryWrite(file, &aged_slices_, sizeof(aged_slices_));
+    }
     door_keeper_.Store(file);
     sketch_.Store(file);
   }
@@ -105,23 +159,160 @@ class TinyLFU<T, SampleSize, NumCounters, true> final {
     sketch_.Reset();
     door_keeper_.Clear();
     global_counter_ = 0;
+    aged_slices_ = 0;
+    ++reset_count_;
   }
 
+  // Lets the users caching the estimations age them as the sketch is aged
+  uint32_t GetResetCount() const noexcept { return reset_count_; }
+
   void Clear() noexcept {
     sketch_.Clear();
     door_keeper_.Clear();
     global_counter_ = 0;
+    aged_slices_ = 0;
   }
 
   bool operator==(const TinyLFU& other) const noexcept {
     return sketch_ == other.sketch_ && door_keeper_ == other.door_keeper_ &&
-           global_counter_ == other.global_counter_;
+           global_counter_ == other.global_counter_ &&
+           aged_slices_ == other.aged_slices_;
   }
 
  private:
-  CountMinSketch<NumCounters> sketch_;
-  BloomFilter<SampleSize> door_keeper_;
+  // The door keeper can't be halved: it's cleared once all the slices are
+  void Age() noexcept {
+    if constexpr (AgingSlices == 1) {
+      Reset();
+    } else {
+      sketch_.ResetSlice(aged_slices_, AgingSlices);
+      global_counter_ = 0;
+      if (++aged_slices_ == AgingSlices) {
+        door_keeper_.Clear();
+        aged_slices_ = 0;
+        ++reset_count_;
+      }
+    }
+  }
+
+  TSketch sketch_;
+  BlockedBloomFilter<SampleSize> door_keeper_;
   TGlobalCounter global_counter_{0};
+  uint32_t aged_slices_{0};
+  uint32_t reset_count_{0};
+};
+
+// TinyLFU shared by many threads without a lock, over the
+// ConcurrentBlockedCountMinSketch. The thread whose addition resets the
+// counter of the aging period ages the sketch (a slice of it, as TinyLFU
+// does), the additions racing it may be lost for the sample. There is no door keeper: clearing it
+// would race the additions. Load, Store and Clear must not race other calls.
+template <class T, size_t SampleSize, size_t NumCounters,
+          size_t AgingSlices = 1>
+  requires(AgingSlices > 0)
+class ConcurrentTinyLFU final {
+ public:
+  using TGlobalCounter = uint32_t;
+  static_assert(SampleSize <= std::numeric_limits<TGlobalCounter>::max());
+  static constexpr size_t kAgingPeriod =
+      std::max<size_t>(1, SampleSize / AgingSlices);
+
+  void Add(T key) noexcept {
+    if (key == std::numeric_limits<T>::max()) return;
+
+    sketch_.Add(key);
+
+    if constexpr (SampleSize > 0) {
+      // the counter may be past the period (a loaded one, or the additions
+      // racing the reset): only the addition which resets it ages the sketch
+      auto counter =
+          global_counter_.fetch_add(1, std::memory_order_relaxed) + 1;
+      while (counter >= kAgingPeriod) {
+        if (global_counter_.compare_exchange_weak(counter, 0,
+                                                  std::memory_order_relaxed)) {
+          Age();
+          break;
+        }
+      }
+    }
+  }
+
+  size_t Estimate(T key) const noexcept {
+    if (key == std::numeric_limits<T>::max()) return 0;
+
+    return sketch_.Estimate(key);
+  }
+
+  void Load(std::ifstream& file) {
+    TGlobalCounter global_counter;
+    utils::BinaryRead(file, &global_counter, sizeof(global_counter));
+    global_counter_.store(global_counter, std::memory_order_relaxed);
+    if constexpr (AgingSlices > 1) {
+      uint32_t aged_slices;
+      utils::BinaryRead(file, &aged_slices, sizeof(aged_slices));
+      aged_slices_.store(aged_slices, std::memory_order_relaxed);
+    }
+    sketch_.Load(file);
+  }
+
+  void Store(std::ofstream& file) const {
+    const TGlobalCounter global_counter =
+        global_counter_.load(std::memory_order_relaxed);
+    utils::BinaryWrite(file, &global_counter, sizeof(global_counter));
+    if constexpr (AgingSlices > 1) {
+      const uint32_t aged_slices = aged_slices_.load(std::memory_order_relaxed);
+      utils::BinaryWrite(file, &aged_slices, sizeof(aged_slices));
+    }
+    sketch_.Store(file);
+  }
+
+  void Reset() noexcept {
+    global_counter_.store(0, std::memory_order_relaxed);
+    aged_slices_.store(0, std::memory_order_relaxed);
+    sketch_.Reset();
+    reset_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Lets the users caching the estimations age them as the sketch is aged
+  uint32_t GetResetCount() const noexcept {
+    return reset_count_.load(std::memory_order_relaxed);
+  }
+
+  void Clear() noexcept {
+    sketch_.Clear();
+    global_counter_.store(0, std::memory_order_relaxed);
+    aged_slices_.store(0, std::memory_order_relaxed);
+  }
+
+  bool operator==(const ConcurrentTinyLFU& other) const noexcept {
+    return sketch_ == other.sketch_ &&
+           global_counter_.load(std::memory_order_relaxed) ==
+               other.global_counter_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // The counter is reset by the caller: the next period starts before the
+  // halving, a slow halving may overlap the next one, of another slice
+  void Age() noexcept {
+    if constexpr (AgingSlices == 1) {
+      sketch_.Reset();
+      reset_count_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      const auto slice =
+          aged_slices_.fetch_add(1, std::memory_order_relaxed) % AgingSlices;
+      sketch_.ResetSlice(slice, AgingSlices);
+      if (slice + 1 == AgingSlices) {
+        aged_slices_.fetch_sub(AgingSlices, std::memory_order_relaxed);
+        reset_count_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  ConcurrentBlockedCountMinSketch<NumCounters> sketch_;
+  // apart from the sketch: the additions don't invalidate its cache lines
+  alignas(64) std::atomic<TGlobalCounter> global_counter_{0};
+  std::atomic<uint32_t> aged_slices_{0};
+  std::atomic<uint32_t> reset_count_{0};
 };
 
 }  // namespace cache
@@ -54,6 +54,15 @@ inline void LoadArrayFromBuffer(const char* buffer,
   }
 }
 
+// A step of splitmix64: every bit of the key affects every bit of the hash,
+// so the keys differing in a few bits get unrelated hashes
+inline uint64_t Mix64(uint64_t x) noexcept {
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
 inline uint32_t Now() {
   static const auto kTimeSinceEpoch =
       std::chrono::steady_clock::now().time_since_epoch().count();
@@ -145,7 +145,9 @@ int main() {
   if (USE_LRU) std::cout << "LRU " << (USE_LRU ? LRU_SIZE : 0) << std::endl;
   if (USE_BF)
     std::cout << "Bloom filter " << (USE_BF ? "ON" : "OFF") << std::endl;
-  if (USE_SIMD) std::cout << "SIMD " << (USE_SIMD ? "ON" : "OFF") << std::endl;
+  if (USE_SIMD) std::cout << "SIMD " << ToString(kSimdLevel) << std::endl;
+  if (USE_ASYNC_SWAP)
+    std::cout << "Async swap " << (USE_ASYNC_SWAP ? "ON" : "OFF") << std::endl;
 #endif
 
   const size_t kBatchSize = 700'000'000;
@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 
 #include <bloom_filter.hpp>
+#include <small_page_filter.hpp>
 
 #include <fstream>
 #include <random>
+#include <vector>
 
 namespace cache::test {
 
@@ -75,4 +77,141 @@ TEST(BloomFilter, SerializeDeserialize) {
   EXPECT_EQ(bf, bf_copy);
 }
 
+TEST(BlockedBloomFilter, AddAndTest) {
+  BlockedBloomFilter<kCapacity> bf;
+
+  for (size_t i = 0; i < kCapacity; ++i) {
+    EXPECT_FALSE(bf.Test(i));
+  }
+
+  EXPECT_FALSE(bf.Add(1));
+  EXPECT_FALSE(bf.Add(2));
+  EXPECT_TRUE(bf.Add(1));
+
+  EXPECT_TRUE(bf.Test(1));
+  EXPECT_TRUE(bf.Test(2));
+
+  bf.Clear();
+  EXPECT_FALSE(bf.Test(1));
+  EXPECT_FALSE(bf.Test(2));
+}
+
+TEST(BlockedBloomFilter, FalsePositiveRate) {
+  BlockedBloomFilter<kCapacity> bf;
+  for (size_t i = 0; i < kCapacity; ++i) bf.Add(i);
+  for (size_t i = 0; i < kCapacity; ++i) EXPECT_TRUE(bf.Test(i));
+
+  size_t false_positives = 0;
+  constexpr size_t kAbsentKeys = 100'000;
+  for (size_t i = 0; i < kAbsentKeys; ++i) {
+    false_positives += bf.Test(kCapacity + i);
+  }
+  EXPECT_LT(false_positives, kAbsentKeys * 3 / 100);
+}
+
+TEST(BlockedBloomFilter, ScalarAndAVX2Blocks) {
+  if (kSimdLevel < SimdLevel::kAVX2) GTEST_SKIP() << "AVX2 isn't supported";
+
+  alignas(32) std::array<uint32_t, detail::kBlockWords> scalar{};
+  alignas(32) std::array<uint32_t, detail::kBlockWords> avx2{};
+  std::mt19937 gen(42);
+  for (size_t i = 0; i < 16; ++i) {
+    const uint32_t hash = gen();
+    EXPECT_EQ(detail::AddToBlock(scalar.data(), hash),
+              detail::AddToBlockAVX2(avx2.data(), hash));
+    EXPECT_EQ(scalar, avx2);
+    const uint32_t other = gen();
+    EXPECT_EQ(detail::TestBlock(scalar.data(), other),
+              detail::TestBlockAVX2(avx2.data(), other));
+  }
+}
+
+TEST(BlockedBloomFilter, SerializeDeserialize) {
+  BlockedBloomFilter<kCapacity> bf;
+  std::mt19937 gen(42);
+  for (size_t i = 0; i < 100; ++i) bf.Add(gen());
+
+  {
+    std::ofstream file("/tmp/blocked_bloom_filter.bin", std::ios::binary);
+    bf.Store(file);
+  }
+  BlockedBloomFilter<kCapacity> from_file;
+  {
+    std::ifstream file("/tmp/blocked_bloom_filter.bin", std::ios::binary);
+    from_file.Load(file);
+  }
+  EXPECT_EQ(bf, from_file);
+
+  std::vector<char> buffer(BlockedBloomFilter<kCapacity>::kDataSizeInBytes);
+  bf.Store(buffer.data());
+  BlockedBloomFilter<kCapacity> from_buffer;
+  from_buffer.Load(buffer.data());
+  EXPECT_EQ(bf, from_buffer);
+}
+
+using TSmallPageBloomFilter = SmallPageBloomFilter<Key, true>;
+
+// the keys of a small page share SmallPageIndex
+std::array<Key, SMALL_PAGE_SIZE> MakeSmallPageRecords() {
+  std::array<Key, SMALL_PAGE_SIZE> records{};
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    records[i] = static_cast<Key>(i * SMALL_PAGE_NUMBER);
+  }
+  return records;
+}
+
+TEST(SmallPageBloomFilter, NoFalseNegatives) {
+  TSmallPageBloomFilter filter;
+  const auto records = MakeSmallPageRecords();
+  for (auto key : records) filter.Add(key);
+  for (auto key : records) EXPECT_TRUE(filter.MayContain(key));
+
+  size_t false_positives = 0;
+  constexpr size_t kAbsentKeys = 10'000;
+  for (size_t i = 0; i < kAbsentKeys; ++i) {
+    false_positives += filter.MayContain(
+        static_cast<Key>((SMALL_PAGE_SIZE + i) * SMALL_PAGE_NUMBER));
+  }
+  EXPECT_LT(false_positives, kAbsentKeys * 3 / 100);
+}
+
+TEST(SmallPageBloomFilter, RebuiltAfterRemovals) {
+  TSmallPageBloomFilter filter;
+  auto records = MakeSmallPageRecords();
+  for (auto key : records) filter.Add(key);
+
+  // the removed keys stay in the filter until it's rebuilt
+  std::vector<Key> removed;
+  for (size_t i = 0; i + 1 < TSmallPageBloomFilter::kMaxStaleKeys; ++i) {
+    removed.push_back(records[i]);
+    records[i] = INVALID_KEY<Key>;
+    filter.OnRemove(records);
+  }
+  for (auto key : removed) EXPECT_TRUE(filter.MayContain(key));
+
+  removed.push_back(records.back());
+  records.back() = INVALID_KEY<Key>;
+  filter.OnRemove(records);
+
+  size_t stale_keys = 0;
+  for (auto key : removed) stale_keys += filter.MayContain(key);
+  EXPECT_LT(stale_keys, removed.size() / 10);
+  for (auto key : records) {
+    if (key != INVALID_KEY<Key>) {
+      EXPECT_TRUE(filter.MayContain(key));
+    }
+  }
+}
+
+TEST(SmallPageBloomFilter, StoreLoad) {
+  TSmallPageBloomFilter filter;
+  for (auto key : MakeSmallPageRecords()) filter.Add(key);
+
+  std::vector<char> buffer(TSmallPageBloomFilter::kDataSizeInBytes);
+  filter.Store(buffer.data());
+  TSmallPageBloomFilter loaded;
+  loaded.Load(buffer.data());
+  EXPECT_EQ(filter, loaded);
+}
+
 }  // namespace cache::test
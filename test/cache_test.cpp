@@ -0,0 +1,222 @@
+#include <gtest/gtest.h>
+
+#include <cache.hpp>
+
+#include "test_utils.hpp"
+
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace cache::test {
+
+namespace {
+
+bool TestBit(const std::vector<uint64_t>& bitmap, size_t i) {
+  return (bitmap[i / 64] >> (i % 64)) & 1;
+}
+
+}  // namespace
+
+TEST(Cache, BasicsNoTTL) {
+  Cache cache{MakeEmptyDir("cache_basics")};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  for (Key key = 0; key < SMALL_PAGE_SIZE; ++key) {
+    EXPECT_FALSE(cache.Get(key, now));
+    cache.Update(key, far_future);
+    EXPECT_TRUE(cache.Get(key, now));
+  }
+}
+
+TEST(Cache, WithoutLRU) {
+  CacheConfig config;
+  config.use_lru = false;
+  config.loaded_page_number = 2;
+  Cache cache{MakeEmptyDir("cache_without_lru"), config};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  for (Key key = 0; key < SMALL_PAGE_SIZE; ++key) {
+    cache.Update(KeyOfLargePage(1, key), far_future);
+    EXPECT_TRUE(cache.Get(KeyOfLargePage(1, key), now));
+  }
+
+  // the page is not loaded (too few accesses to swap it in) and there is no
+  // LRU to keep the keys
+  for (Key key = 0; key < FREQUENCY_THRESHOLD / 4; ++key) {
+    cache.Update(KeyOfLargePage(2, key), far_future);
+    EXPECT_FALSE(cache.Get(KeyOfLargePage(2, key), now));
+  }
+}
+
+TEST(Cache, Keys64) {
+  auto cache = std::make_unique<Cache64>(MakeEmptyDir("cache_keys64"));
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // keys of the loaded large pages, every key has a twin which differs only
+  // in the high half; the first keys are evicted from the LRU to the pages
+  constexpr uint64_t kHighBit = 1ull << 40;
+  const size_t kNumKeys = static_cast<size_t>(LRU_SIZE) + 1000;
+  auto key_of = [](size_t i) {
+    const uint64_t page = i % LOADED_PAGE_NUMBER;
+    return (page << (64 - LARGE_PAGE_SHIFT)) | kHighBit | i;
+  };
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    cache->Update(key_of(i), far_future);
+  }
+
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    EXPECT_TRUE(cache->Get(key_of(i), now));
+    EXPECT_FALSE(cache->Get(key_of(i) & ~kHighBit, now));
+  }
+}
+
+TEST(Cache, GetUpdateBatch) {
+  auto cache = std::make_unique<Cache>(MakeEmptyDir("cache_batch"));
+
+  std::random_device rd;
+  const auto seed = rd();
+  std::cout << "Seed: " << seed << std::endl;
+  std::mt19937 gen(seed);
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // the key of a not loaded page, it's evicted from the LRU and dropped
+  const Key absent_key = KeyOfLargePage(LOADED_PAGE_NUMBER, 0);
+  std::vector<Key> keys{absent_key};
+
+  // last LRU_SIZE keys fill the LRU, the rest go to the loaded large pages
+  const size_t kNumKeys = static_cast<size_t>(LRU_SIZE) + 1000;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    keys.push_back(
+        KeyOfLargePage(gen() % LOADED_PAGE_NUMBER, static_cast<Key>(i)));
+  }
+
+  std::vector<uint64_t> hits((keys.size() + 63) / 64);
+  cache->GetBatch(keys, now, hits);
+  for (size_t i = 0; i < keys.size(); ++i) EXPECT_FALSE(TestBit(hits, i));
+
+  cache->UpdateBatch(keys, far_future);
+
+  cache->GetBatch(keys, now, hits);
+  EXPECT_FALSE(TestBit(hits, 0));
+  for (size_t i = 1; i < keys.size(); ++i) {
+    EXPECT_TRUE(TestBit(hits, i));
+    EXPECT_TRUE(cache->Get(keys[i], now));
+  }
+  EXPECT_FALSE(cache->Get(absent_key, now));
+}
+
+TEST(Cache, FixedValues) {
+  auto cache = std::make_unique<BasicCache<Key, FixedValues<uint64_t>>>(
+      MakeEmptyDir("cache_values"));
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // the first keys are evicted from the LRU to the large pages
+  const size_t kNumKeys = static_cast<size_t>(LRU_SIZE) + 1000;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const Key key =
+        KeyOfLargePage(i % LOADED_PAGE_NUMBER, static_cast<Key>(i));
+    cache->Update(key, far_future, i);
+  }
+
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    const Key key =
+        KeyOfLargePage(i % LOADED_PAGE_NUMBER, static_cast<Key>(i));
+    uint64_t value = 0;
+    EXPECT_TRUE(cache->Get(key, now, &value));
+    EXPECT_EQ(value, i);
+  }
+
+  std::vector<Key> keys{KeyOfLargePage(0, 0), KeyOfLargePage(1, 1)};
+  std::vector<uint64_t> hits(1);
+  std::vector<uint64_t> values(keys.size());
+  cache->GetBatch(keys, now, hits, values);
+  EXPECT_TRUE(TestBit(hits, 0) && TestBit(hits, 1));
+  EXPECT_EQ(values, (std::vector<uint64_t>{0, 1}));
+}
+
+// The updates of a key in a batch are applied in the order of the batch,
+// both by the comparison sort of a small batch and the counting sort of a
+// large one
+TEST(Cache, UpdateBatchKeepsOrder) {
+  CacheConfig config;
+  config.use_lru = false;
+  for (size_t batch_size : {64, 1024}) {
+    auto cache = std::make_unique<BasicCache<Key, FixedValues<uint64_t>>>(
+        MakeEmptyDir("cache_batch_order"), config);
+
+    const auto now = utils::Now();
+    const auto far_future = now + 3600;
+
+    // every key is updated batch_size / 8 times
+    auto key_of = [](size_t i) {
+      return KeyOfLargePage(i % 4, static_cast<Key>(i % 8));
+    };
+    std::vector<Key> keys;
+    std::vector<uint64_t> values;
+    for (size_t i = 0; i < batch_size; ++i) {
+      keys.push_back(key_of(i));
+      values.push_back(i);
+    }
+    cache->UpdateBatch(keys, far_future, values);
+
+    for (size_t i = batch_size - 8; i < batch_size; ++i) {
+      uint64_t value = 0;
+      EXPECT_TRUE(cache->Get(key_of(i), now, &value));
+      EXPECT_EQ(value, i);
+    }
+  }
+}
+
+TEST(Cache, AdaptiveLRU) {
+  CacheConfig config;
+  config.adaptive_lru = true;
+  config.min_lru_size = 50;
+  config.lru_size = config.max_lru_size = 200;
+  config.lru_climb_period = 100;
+  auto cache = std::make_unique<Cache>(MakeEmptyDir("cache_adaptive_lru"),
+                                       config);
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  auto key_of = [](size_t i) {
+    return KeyOfLargePage(i % LOADED_PAGE_NUMBER, static_cast<Key>(i));
+  };
+  for (size_t i = 0; i < config.lru_size; ++i) {
+    cache->Update(key_of(i), far_future);
+  }
+
+  // a period of hits, then a period of misses shrinks the LRU
+  for (size_t i = 0; i < config.lru_climb_period; ++i) {
+    EXPECT_TRUE(cache->Get(key_of(i), now));
+  }
+  for (size_t i = 0; i < config.lru_climb_period; ++i) {
+    EXPECT_FALSE(cache->Get(key_of(config.lru_size + i), now));
+  }
+
+  // the victims of the shrinks went to the loaded large pages
+  for (size_t i = 0; i < config.lru_size; ++i) {
+    EXPECT_TRUE(cache->Get(key_of(i), now));
+  }
+}
+
+TEST(Cache, AdaptiveLRUInvalidSize) {
+  CacheConfig config;
+  config.adaptive_lru = true;
+  config.lru_size = config.max_lru_size + 1;
+  EXPECT_THROW(Cache(MakeEmptyDir("cache_adaptive_lru_invalid"), config),
+               std::invalid_argument);
+}
+
+}  // namespace cache::test
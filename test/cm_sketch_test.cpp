@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <memory>
+#include <random>
 #include <unordered_map>
+#include <vector>
 
 #include <cm_sketch.hpp>
 
@@ -105,4 +111,252 @@ TEST(CountMinSketch, SerializeDeserialize) {
   }
 }
 
+TEST(CountMinSketch, Keys64DifferInHighBits) {
+  CountMinSketch<1024> sketch;
+  const uint64_t key = 0;
+  const uint64_t other_key = key + (1ull << 32);
+  for (size_t i = 0; i < 4; i++) {
+    sketch.Add(key);
+  }
+  EXPECT_EQ(sketch.Estimate(key), 4);
+  EXPECT_EQ(sketch.Estimate(other_key), 0);
+}
+
+// sequentially allocated ids with a stride of the number of counters
+TEST(CountMinSketch, StridedKeys) {
+  constexpr uint32_t kNumCounters = 1024;
+  constexpr uint32_t kNumKeys = 64;
+
+  CountMinSketch<kNumCounters> sketch;
+  CountMinSketch<kNumCounters, CmsXorSeedHashing> xor_seed_sketch;
+  for (uint32_t i = 0; i < kNumKeys; i++) {
+    sketch.Add(i * kNumCounters);
+    xor_seed_sketch.Add(i * kNumCounters);
+  }
+
+  for (uint32_t i = 0; i < kNumKeys; i++) {
+    EXPECT_LE(sketch.Estimate(i * kNumCounters), 2);
+    // the low bits of the keys are the same: all the keys alias
+    EXPECT_EQ(xor_seed_sketch.Estimate(i * kNumCounters), 15);
+  }
+}
+
+TEST(CountMinSketch, XorSeedHashingSerializeDeserialize) {
+  CountMinSketch<64, CmsXorSeedHashing> sketch;
+  for (uint32_t key = 0; key < 32; key++) sketch.Add(key);
+
+  {
+    std::ofstream file("/tmp/cms_xor_seed.bin", std::ios::binary);
+    sketch.Store(file);
+  }
+  CountMinSketch<64, CmsXorSeedHashing> loaded;
+  {
+    std::ifstream file("/tmp/cms_xor_seed.bin", std::ios::binary);
+    loaded.Load(file);
+  }
+  for (uint32_t key = 0; key < 32; key++) {
+    EXPECT_EQ(loaded.Estimate(key), sketch.Estimate(key));
+  }
+}
+
+TEST(BlockedCountMinSketch, SizeOf) {
+  // as much memory as the sketch of separate rows, but at least a block
+  static_assert(sizeof(BlockedCountMinSketch<1024>) ==
+                sizeof(CountMinSketch<1024>) + 48);
+  static_assert(BlockedCountMinSketch<1024>::kNumBlocks == 32);
+  static_assert(BlockedCountMinSketch<4>::kNumBlocks == 1);
+}
+
+TEST(BlockedCountMinSketch, AddEstimateReset) {
+  BlockedCountMinSketch<1024> sketch;
+  for (size_t i = 1; i <= 20; i++) {
+    sketch.Add(5);
+    EXPECT_EQ(sketch.Estimate(5), std::min<size_t>(i, 15));
+  }
+  EXPECT_EQ(sketch.Estimate(6), 0);
+
+  sketch.Reset();
+  EXPECT_EQ(sketch.Estimate(5), 7);
+
+  sketch.Clear();
+  EXPECT_EQ(sketch.Estimate(5), 0);
+}
+
+TEST(BlockedCountMinSketch, NoUnderestimation) {
+  BlockedCountMinSketch<1024> sketch;
+  std::mt19937 gen(42);
+  std::unordered_map<uint64_t, size_t> keys_freqs;
+  for (size_t i = 0; i < 1000; ++i) {
+    const uint64_t key = gen() % 200 + (static_cast<uint64_t>(gen()) << 32);
+    ++keys_freqs[key];
+    sketch.Add(key);
+  }
+
+  for (auto [key, count] : keys_freqs) {
+    EXPECT_GE(sketch.Estimate(key), std::min<size_t>(count, 15));
+  }
+}
+
+TEST(BlockedCountMinSketch, ScalarAndAVX2Kernels) {
+  if (kSimdLevel < SimdLevel::kAVX2) GTEST_SKIP() << "AVX2 isn't supported";
+
+  constexpr size_t kWords = 4 * details::kSketchBlockWords;
+  alignas(64) std::array<uint64_t, kWords> scalar{};
+  alignas(64) std::array<uint64_t, kWords> avx2{};
+  std::mt19937_64 gen(42);
+  for (size_t i = 0; i < 1000; ++i) {
+    // few distinct hashes to saturate some counters
+    const uint64_t hash = gen() % 64;
+    const size_t block = hash % 4 * details::kSketchBlockWords;
+    details::AddToBlock(&scalar[block], hash);
+    details::AddToBlockAVX2(&avx2[block], hash);
+    ASSERT_EQ(scalar, avx2);
+
+    const uint64_t other = gen() % 64;
+    const size_t other_block = other % 4 * details::kSketchBlockWords;
+    EXPECT_EQ(details::EstimateInBlock(&scalar[other_block], other),
+              details::EstimateInBlockAVX2(&avx2[other_block], other));
+
+  }
+}
+
+template <size_t CounterBits, class TCell>
+void CheckHalveCountersKernels() {
+  std::mt19937 gen(42);
+  // odd sizes to halve the tails of the kernels
+  for (size_t size : {1, 7, 33, 100}) {
+    std::vector<TCell> expected(size);
+    for (auto& cell : expected) cell = gen();
+    auto scalar = expected;
+    auto avx2 = expected;
+    for (auto& cell : expected) {
+      TCell halved = 0;
+      for (size_t shift = 0; shift < 8 * sizeof(TCell); shift += CounterBits) {
+        const TCell counter = (cell >> shift) & ((1u << CounterBits) - 1);
+        halved |= static_cast<TCell>((counter >> 1) << shift);
+      }
+      cell = halved;
+    }
+
+    const auto bytes = size * sizeof(TCell);
+    details::HalveCounters<CounterBits>(
+        reinterpret_cast<uint8_t*>(scalar.data()), bytes);
+    EXPECT_EQ(scalar, expected);
+    if (kSimdLevel >= SimdLevel::kAVX2) {
+      details::HalveCountersAVX2<CounterBits>(
+          reinterpret_cast<uint8_t*>(avx2.data()), bytes);
+      EXPECT_EQ(avx2, expected);
+    }
+  }
+}
+
+TEST(CountMinSketch, HalveCountersKernels) {
+  CheckHalveCountersKernels<4, uint8_t>();
+  CheckHalveCountersKernels<8, uint8_t>();
+  CheckHalveCountersKernels<16, uint16_t>();
+}
+
+template <size_t CounterBits>
+void CheckCounterWidth() {
+  using TSketch =
+      CountMinSketch<1024, CmsMultiplyShiftHashing, CounterBits>;
+  static_assert(sizeof(TSketch) ==
+                details::CM_DEPTH * 1024 * CounterBits / 8 + 16);
+  constexpr size_t kMaxCount = (1u << CounterBits) - 1;
+  auto sketch = std::make_unique<TSketch>();
+
+  const size_t adds = std::min<size_t>(kMaxCount + 10, 1000);
+  for (size_t i = 1; i <= adds; ++i) {
+    sketch->Add(5);
+    EXPECT_EQ(sketch->Estimate(5), std::min(i, kMaxCount));
+  }
+  EXPECT_EQ(sketch->Estimate(6), 0);
+
+  sketch->Reset();
+  EXPECT_EQ(sketch->Estimate(5), std::min(adds, kMaxCount) / 2);
+
+  {
+    std::ofstream file("/tmp/sketch_width.bin", std::ios::binary);
+    sketch->Store(file);
+  }
+  auto loaded = std::make_unique<TSketch>();
+  {
+    std::ifstream file("/tmp/sketch_width.bin", std::ios::binary);
+    loaded->Load(file);
+  }
+  EXPECT_TRUE(*loaded == *sketch);
+  EXPECT_EQ(loaded->Estimate(5), sketch->Estimate(5));
+}
+
+TEST(CountMinSketch, CounterWidths) {
+  CheckCounterWidth<4>();
+  CheckCounterWidth<8>();
+  CheckCounterWidth<16>();
+}
+
+// Halving all the slices one by one is a Reset
+TEST(CountMinSketch, ResetSlices) {
+  constexpr size_t kNumSlices = 7;
+  CountMinSketch<1024> sketch;
+  BlockedCountMinSketch<1024> blocked_sketch;
+  std::mt19937 gen(42);
+  for (size_t i = 0; i < 10000; ++i) {
+    const auto key = gen() % 2000;
+    sketch.Add(key);
+    blocked_sketch.Add(key);
+  }
+  auto reset = sketch;
+  auto blocked_reset = blocked_sketch;
+  reset.Reset();
+  blocked_reset.Reset();
+
+  for (size_t slice = 0; slice < kNumSlices; ++slice) {
+    EXPECT_FALSE(sketch == reset);
+    EXPECT_FALSE(blocked_sketch == blocked_reset);
+    sketch.ResetSlice(slice, kNumSlices);
+    blocked_sketch.ResetSlice(slice, kNumSlices);
+  }
+  EXPECT_TRUE(sketch == reset);
+  EXPECT_TRUE(blocked_sketch == blocked_reset);
+}
+
+TEST(BlockedCountMinSketch, SerializeDeserialize) {
+  BlockedCountMinSketch<1000> sketch;
+  std::mt19937 gen(42);
+  for (size_t i = 0; i < 10000; ++i) sketch.Add(gen());
+
+  {
+    std::ofstream file("/tmp/blocked_sketch.bin", std::ios::binary);
+    sketch.Store(file);
+  }
+  BlockedCountMinSketch<1000> loaded;
+  {
+    std::ifstream file("/tmp/blocked_sketch.bin", std::ios::binary);
+    loaded.Load(file);
+  }
+  EXPECT_EQ(loaded, sketch);
+
+  gen.seed(42);
+  for (size_t i = 0; i < 10000; ++i) {
+    const auto key = gen();
+    EXPECT_EQ(loaded.Estimate(key), sketch.Estimate(key));
+  }
+}
+
+TEST(ConcurrentBlockedCountMinSketch, AddEstimateReset) {
+  ConcurrentBlockedCountMinSketch<1024> sketch;
+  static_assert(sizeof(sketch) == sizeof(BlockedCountMinSketch<1024>));
+  for (size_t i = 1; i <= 20; i++) {
+    sketch.Add(5);
+    EXPECT_EQ(sketch.Estimate(5), std::min<size_t>(i, 15));
+  }
+  EXPECT_EQ(sketch.Estimate(6), 0);
+
+  sketch.Reset();
+  EXPECT_EQ(sketch.Estimate(5), 7);
+
+  sketch.Clear();
+  EXPECT_EQ(sketch.Estimate(5), 0);
+}
+
 }  // namespace cache::test
@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <flat_lru.hpp>
+
+#include <algorithm>
+#include <list>
+#include <random>
+#include <string>
+
+namespace cache::test {
+
+TEST(FlatLRU, BasicWithTTL) {
+  FlatLRU<uint32_t> lru{3};
+
+  const auto now = utils::Now();
+  const auto future = now + 3600;
+
+  EXPECT_FALSE(lru.Update(1, future).has_value());
+  EXPECT_FALSE(lru.Update(2, future).has_value());
+  EXPECT_FALSE(lru.Update(3, future).has_value());
+
+  EXPECT_TRUE(lru.Get(1, now));
+  EXPECT_TRUE(lru.Get(2, now));
+  EXPECT_TRUE(lru.Get(3, now));
+
+  EXPECT_FALSE(lru.Get(1, future + 60));
+  EXPECT_FALSE(lru.Get(2, future + 60));
+  EXPECT_FALSE(lru.Get(3, future + 60));
+}
+
+TEST(FlatLRU, EvictionNoTTL) {
+  FlatLRU<uint32_t> lru{3};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  EXPECT_FALSE(lru.Update(1, far_future).has_value());
+  EXPECT_FALSE(lru.Update(2, far_future).has_value());
+  EXPECT_FALSE(lru.Update(3, far_future).has_value());
+
+  EXPECT_TRUE(lru.Get(1, now));
+  EXPECT_TRUE(lru.Get(1, now));
+  EXPECT_TRUE(lru.Get(2, now));
+
+  std::optional<uint32_t> evicted{};
+  EXPECT_TRUE(evicted = lru.Update(4, far_future));
+  EXPECT_EQ(*evicted, 3);  // 3 is evicted
+  EXPECT_FALSE(lru.Get(3, now));
+
+  EXPECT_TRUE(lru.Get(1, now));  // rest are still there
+  EXPECT_TRUE(lru.Get(2, now));
+}
+
+TEST(FlatLRU, MaxSizeGreaterThanZeroNoTTL) {
+  FlatLRU<uint32_t> lru{0};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  EXPECT_FALSE(lru.Update(1, far_future).has_value());
+  EXPECT_TRUE(lru.Update(2, far_future).has_value());
+
+  EXPECT_FALSE(lru.Get(1, now));
+  EXPECT_TRUE(lru.Get(2, now));
+}
+
+TEST(FlatLRU, ValuesNoTTL) {
+  FlatLRU<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, std::string>
+      lru{2};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  EXPECT_FALSE(lru.UpdateEntry(1, far_future, "a").has_value());
+  EXPECT_FALSE(lru.UpdateEntry(2, far_future, "b").has_value());
+  EXPECT_FALSE(lru.UpdateEntry(1, far_future + 1, "c").has_value());
+
+  std::string value;
+  EXPECT_TRUE(lru.Get(1, now, &value));
+  EXPECT_EQ(value, "c");
+
+  auto evicted = lru.UpdateEntry(3, far_future, "d");
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->key, 2);
+  EXPECT_EQ(evicted->expiration_time, far_future);
+  EXPECT_EQ(evicted->value, "b");
+}
+
+// The keys collide in the small table, so the removals shift the probe
+// sequences: both LRUs must evict and expire the same keys
+TEST(FlatLRU, SameAsLRU) {
+  constexpr size_t kSize = 100;
+  LRU<uint32_t> lru{kSize};
+  FlatLRU<uint32_t> flat_lru{kSize};
+
+  const auto now = utils::Now();
+  std::mt19937 rng;
+  for (size_t i = 0; i < 100'000; ++i) {
+    const uint32_t key = rng() % (3 * kSize);
+    if (rng() % 2 == 0) {
+      // a tenth of the keys expires on the next access
+      const auto expiration_time = rng() % 10 == 0 ? now - 1 : now + 3600;
+      ASSERT_EQ(lru.Update(key, expiration_time),
+                flat_lru.Update(key, expiration_time));
+    } else {
+      ASSERT_EQ(lru.Get(key, now), flat_lru.Get(key, now));
+    }
+  }
+}
+
+// The LRU order survives the shrinks: the same entries are evicted
+TEST(FlatLRU, SameAsLRUResized) {
+  constexpr size_t kCapacity = 100;
+  LRU<uint32_t> lru{kCapacity};
+  FlatLRU<uint32_t> flat_lru{kCapacity};
+
+  const auto now = utils::Now();
+  std::mt19937 rng;
+  for (size_t i = 0; i < 100'000; ++i) {
+    const uint32_t key = rng() % (3 * kCapacity);
+    if (i % 1000 == 0) {
+      const size_t max_size = 1 + rng() % kCapacity;
+      lru.SetMaxSize(max_size);
+      flat_lru.SetMaxSize(max_size);
+      for (;;) {
+        const auto evicted = lru.EvictExcess();
+        const auto flat_evicted = flat_lru.EvictExcess();
+        ASSERT_EQ(evicted.has_value(), flat_evicted.has_value());
+        if (!evicted) break;
+        ASSERT_EQ(evicted->key, flat_evicted->key);
+      }
+    } else if (rng() % 2 == 0) {
+      const auto expiration_time = rng() % 10 == 0 ? now - 1 : now + 3600;
+      ASSERT_EQ(lru.Update(key, expiration_time),
+                flat_lru.Update(key, expiration_time));
+    } else {
+      ASSERT_EQ(lru.Get(key, now), flat_lru.Get(key, now));
+    }
+  }
+}
+
+TEST(SieveCache, EvictionNoTTL) {
+  SieveCache<uint32_t> sieve{3};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  EXPECT_FALSE(sieve.Update(1, far_future).has_value());
+  EXPECT_FALSE(sieve.Update(2, far_future).has_value());
+  EXPECT_FALSE(sieve.Update(3, far_future).has_value());
+  EXPECT_TRUE(sieve.Get(1, now));
+
+  // the hand unmarks the visited 1 and moves on to the newer entries
+  EXPECT_EQ(sieve.Update(4, far_future), 2);
+  EXPECT_EQ(sieve.Update(5, far_future), 3);
+  EXPECT_EQ(sieve.Update(6, far_future), 4);
+  EXPECT_EQ(sieve.Update(7, far_future), 5);
+  EXPECT_EQ(sieve.Update(8, far_future), 6);
+  EXPECT_TRUE(sieve.Get(7, now));
+  EXPECT_TRUE(sieve.Get(8, now));
+  // the hand unmarks 7 and 8 and wraps around to the oldest entry
+  EXPECT_EQ(sieve.Update(9, far_future), 1);
+  EXPECT_EQ(sieve.Update(10, far_future), 7);
+
+  EXPECT_TRUE(sieve.Get(8, now));
+  EXPECT_TRUE(sieve.Get(9, now));
+  EXPECT_TRUE(sieve.Get(10, now));
+}
+
+// A list-based SIEVE: the front is the newest entry
+class SieveModel {
+ public:
+  explicit SieveModel(size_t max_size) : max_size_(max_size) {}
+
+  std::optional<uint32_t> Update(uint32_t key, uint32_t expiration_time) {
+    if (auto it = Find(key); it != entries_.end()) {
+      it->expiration_time = expiration_time;
+      it->visited = true;
+      return std::nullopt;
+    }
+
+    std::optional<uint32_t> evicted;
+    if (entries_.size() >= max_size_) evicted = Evict();
+    entries_.push_front({key, expiration_time, false});
+    return evicted;
+  }
+
+  void SetMaxSize(size_t max_size) { max_size_ = max_size; }
+
+  std::optional<uint32_t> EvictExcess() {
+    if (entries_.size() <= max_size_) return std::nullopt;
+    return Evict();
+  }
+
+  bool Get(uint32_t key, uint32_t now) {
+    auto it = Find(key);
+    if (it == entries_.end()) return false;
+    if (it->expiration_time < now) {
+      if (hand_ == it) hand_ = Erase(it);
+      else Erase(it);
+      return false;
+    }
+    it->visited = true;
+    return true;
+  }
+
+ private:
+  struct Entry {
+    uint32_t key;
+    uint32_t expiration_time;
+    bool visited;
+  };
+  using Iterator = std::list<Entry>::iterator;
+
+  uint32_t Evict() {
+    auto it = hand_;
+    for (;; --it) {
+      if (it == entries_.end()) it = std::prev(entries_.end());
+      if (!it->visited) break;
+      it->visited = false;
+      if (it == entries_.begin()) it = entries_.end();
+    }
+    const auto key = it->key;
+    hand_ = Erase(it);
+    return key;
+  }
+
+  Iterator Find(uint32_t key) {
+    return std::find_if(entries_.begin(), entries_.end(),
+                        [&](const Entry& entry) { return entry.key == key; });
+  }
+
+  // The next hand: the newer entry or the end to restart from the oldest one
+  Iterator Erase(Iterator it) {
+    auto newer = it == entries_.begin() ? entries_.end() : std::prev(it);
+    entries_.erase(it);
+    return newer;
+  }
+
+  size_t max_size_;
+  std::list<Entry> entries_;
+  Iterator hand_ = entries_.end();
+};
+
+TEST(SieveCache, SameAsModel) {
+  constexpr size_t kSize = 100;
+  SieveModel model{kSize};
+  SieveCache<uint32_t> sieve{kSize};
+
+  const auto now = utils::Now();
+  std::mt19937 rng;
+  for (size_t i = 0; i < 100'000; ++i) {
+    const uint32_t key = rng() % (3 * kSize);
+    if (rng() % 2 == 0) {
+      // a tenth of the keys expires on the next access
+      const auto expiration_time = rng() % 10 == 0 ? now - 1 : now + 3600;
+      ASSERT_EQ(model.Update(key, expiration_time),
+                sieve.Update(key, expiration_time));
+    } else {
+      ASSERT_EQ(model.Get(key, now), sieve.Get(key, now));
+    }
+  }
+}
+
+TEST(SieveCache, SameAsModelResized) {
+  constexpr size_t kCapacity = 100;
+  SieveModel model{kCapacity};
+  SieveCache<uint32_t> sieve{kCapacity};
+
+  const auto now = utils::Now();
+  std::mt19937 rng;
+  for (size_t i = 0; i < 100'000; ++i) {
+    const uint32_t key = rng() % (3 * kCapacity);
+    if (i % 1000 == 0) {
+      const size_t max_size = 1 + rng() % kCapacity;
+      model.SetMaxSize(max_size);
+      sieve.SetMaxSize(max_size);
+      for (;;) {
+        const auto evicted = model.EvictExcess();
+        const auto sieve_evicted = sieve.EvictExcess();
+        ASSERT_EQ(evicted.has_value(), sieve_evicted.has_value());
+        if (!evicted) break;
+        ASSERT_EQ(*evicted, sieve_evicted->key);
+      }
+    } else if (rng() % 2 == 0) {
+      const auto expiration_time = rng() % 10 == 0 ? now - 1 : now + 3600;
+      ASSERT_EQ(model.Update(key, expiration_time),
+                sieve.Update(key, expiration_time));
+    } else {
+      ASSERT_EQ(model.Get(key, now), sieve.Get(key, now));
+    }
+  }
+}
+
+}  // namespace cache::test
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <hill_climber.hpp>
+
+#include <optional>
+
+namespace cache::test {
+
+namespace {
+
+// Records a period of `period` accesses with `hits` hits
+std::optional<size_t> RecordPeriod(HillClimber& climber, size_t period,
+                                   size_t hits) {
+  std::optional<size_t> size;
+  for (size_t i = 0; i < period; ++i) {
+    size = climber.Record(i < hits);
+    if (i + 1 < period) {
+      EXPECT_FALSE(size.has_value());
+    }
+  }
+  return size;
+}
+
+}  // namespace
+
+TEST(HillClimber, KeepsDirectionWhileHitRatioGrows) {
+  constexpr size_t kPeriod = 1000;
+  // a full step is 1/16 of the max size
+  HillClimber climber(100, 1600, 800, kPeriod);
+
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 500), 900);
+  // the step decays while the hit ratio changes a little
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 510), 1000);
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 515), 1098);
+  EXPECT_EQ(climber.Size(), 1098);
+}
+
+TEST(HillClimber, TurnsBackWhenHitRatioDrops) {
+  constexpr size_t kPeriod = 1000;
+  HillClimber climber(100, 1600, 800, kPeriod);
+
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 500), 900);
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 490), 800);
+  // the hit ratio grows again: the new direction is kept
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 495), 702);
+}
+
+TEST(HillClimber, RestartsOnHitRatioJump) {
+  constexpr size_t kPeriod = 1000;
+  HillClimber climber(100, 1600, 800, kPeriod);
+
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 500), 900);
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 505), 1000);
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 506), 1098);
+  // a new workload: the drop turns back by the decayed step, the next move
+  // takes the full step
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 300), 1002);
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 301), 902);
+}
+
+TEST(HillClimber, StaysWithinBounds) {
+  constexpr size_t kPeriod = 10;
+  HillClimber climber(100, 160, 150, kPeriod);
+
+  // a step is 10 entries, the hit ratio keeps growing
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 1), 160);
+  EXPECT_FALSE(RecordPeriod(climber, kPeriod, 2).has_value());
+  EXPECT_EQ(climber.Size(), 160);
+
+  // the hit ratio drops and stays, the size goes down to the min one
+  EXPECT_EQ(RecordPeriod(climber, kPeriod, 0), 150);
+  for (size_t i = 0; i < 20; ++i) RecordPeriod(climber, kPeriod, 0);
+  EXPECT_EQ(climber.Size(), 100);
+}
+
+}  // namespace cache::test
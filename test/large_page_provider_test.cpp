@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <cache.hpp>
+
+#include "test_utils.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace cache::test {
+
+// The modes of the swaps and of the startup load of the provider
+struct ProviderMode {
+  bool async_swap;
+  bool lazy_load;
+  bool warm_up_lazy_pages;
+};
+
+class LargePageProviderTest : public ::testing::TestWithParam<ProviderMode> {
+ protected:
+  static CacheConfig MakeConfig() {
+    CacheConfig config;
+    config.async_swap = GetParam().async_swap;
+    config.lazy_load = GetParam().lazy_load;
+    config.warm_up_lazy_pages = GetParam().warm_up_lazy_pages;
+    return config;
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(
+    Modes, LargePageProviderTest,
+    ::testing::Values(ProviderMode{false, false, false},
+                      ProviderMode{true, false, false},
+                      ProviderMode{false, true, false},
+                      ProviderMode{false, true, true},
+                      ProviderMode{true, true, true}),
+    [](const auto& info) {
+      const auto& mode = info.param;
+      std::string name = mode.async_swap ? "AsyncSwap" : "SyncSwap";
+      if (!mode.lazy_load) return name + "EagerLoad";
+      return name + (mode.warm_up_lazy_pages ? "LazyLoadWarmUp" : "LazyLoad");
+    });
+
+namespace {
+
+// Stores a page with the key `KeyOfLargePage(i, 1)` for each of the first
+// LOADED_PAGE_NUMBER pages
+void StorePagesWithKeys(const std::filesystem::path& dir_path,
+                        uint32_t expiration_time) {
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{dir_path, tiny_lfu};
+  for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    const Key key = KeyOfLargePage(i, 1);
+    provider.Get</*CalledOnUpdate=*/true>(key)->Update(key, expiration_time);
+  }
+  provider.Store();
+}
+
+}  // namespace
+
+TEST_P(LargePageProviderTest, LoadedPagesOnEmptyDir) {
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{MakeEmptyDir("provider_empty_dir"), tiny_lfu,
+                             MakeConfig()};
+
+  for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    EXPECT_NE(provider.Get</*CalledOnUpdate=*/false>(KeyOfLargePage(i)),
+              nullptr);
+  }
+  EXPECT_EQ(provider.Get</*CalledOnUpdate=*/false>(
+                KeyOfLargePage(LOADED_PAGE_NUMBER)),
+            nullptr);
+}
+
+TEST_P(LargePageProviderTest, LoadedPageNumberFromConfig) {
+  TTinyLFU tiny_lfu;
+  CacheConfig config = MakeConfig();
+  config.loaded_page_number = 3;
+  LargePageProvider provider{MakeEmptyDir("provider_config"), tiny_lfu,
+                             config};
+
+  for (size_t i = 0; i < config.loaded_page_number; ++i) {
+    EXPECT_NE(provider.Get</*CalledOnUpdate=*/false>(KeyOfLargePage(i)),
+              nullptr);
+  }
+  EXPECT_EQ(provider.Get</*CalledOnUpdate=*/false>(
+                KeyOfLargePage(config.loaded_page_number)),
+            nullptr);
+
+  config.loaded_page_number = 0;
+  EXPECT_THROW((LargePageProvider{MakeEmptyDir("provider_no_pages"), tiny_lfu,
+                                  config}),
+               std::invalid_argument);
+
+  // a shard owns every other page
+  config.loaded_page_number = LARGE_PAGE_NUMBER / 2 + 1;
+  config.shard_number = 2;
+  EXPECT_THROW((LargePageProvider{MakeEmptyDir("provider_shard_pages"),
+                                  tiny_lfu, config}),
+               std::invalid_argument);
+  config.loaded_page_number = 1;
+  config.shard_index = 2;
+  EXPECT_THROW((LargePageProvider{MakeEmptyDir("provider_shard_index"),
+                                  tiny_lfu, config}),
+               std::invalid_argument);
+}
+
+TEST_P(LargePageProviderTest, LoadStoredPages) {
+  const auto dir_path = MakeEmptyDir("provider_load_stored");
+
+  const auto now = utils::Now();
+  StorePagesWithKeys(dir_path, now + 3600);
+
+  // pages are read on startup, on the first access or by the warm-up
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{dir_path, tiny_lfu, MakeConfig()};
+  for (size_t i = LOADED_PAGE_NUMBER; i-- > 0;) {
+    const Key key = KeyOfLargePage(i, 1);
+    auto* page = provider.Get</*CalledOnUpdate=*/false>(key);
+    ASSERT_NE(page, nullptr);
+    EXPECT_TRUE(page->Get(key, now));
+  }
+}
+
+TEST_P(LargePageProviderTest, LazyPagesAreReadOnFirstAccess) {
+  const auto dir_path = MakeEmptyDir("provider_lazy_load");
+
+  const auto now = utils::Now();
+  StorePagesWithKeys(dir_path, now + 3600);
+
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{dir_path, tiny_lfu, MakeConfig()};
+  provider.WaitForPendingSwaps();
+
+  // empty pages on the disk: only the pages read before are found
+  {
+    TLargePageStore store{dir_path};
+    auto empty_page = std::make_unique<LargePage>(tiny_lfu);
+    for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) store.Store(i, *empty_page);
+    store.Flush();
+  }
+  const bool read_on_startup =
+      !GetParam().lazy_load || GetParam().warm_up_lazy_pages;
+  for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    const Key key = KeyOfLargePage(i, 1);
+    auto* page = provider.Get</*CalledOnUpdate=*/false>(key);
+    ASSERT_NE(page, nullptr);
+    EXPECT_EQ(page->Get(key, now), read_on_startup);
+  }
+}
+
+TEST_P(LargePageProviderTest, StoreAppliesBufferedHits) {
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{MakeEmptyDir("provider_buffered_hits"),
+                             tiny_lfu, MakeConfig()};
+
+  const auto now = utils::Now();
+  const Key key = KeyOfLargePage(0);
+  LargePage* page = provider.Get</*CalledOnUpdate=*/true>(key);
+  page->Update(key, now + 3600);
+  const auto estimate = tiny_lfu.Estimate(key);
+
+  // fewer hits than the buffer holds: they aren't counted yet
+  constexpr size_t kHits = SMALL_PAGE_READ_BUFFER_SIZE / 2;
+  for (size_t i = 0; i < kHits; ++i) {
+    EXPECT_TRUE(page->Get(key, now));
+  }
+  if constexpr (SMALL_PAGE_READ_BUFFER_SIZE > 1) {
+    EXPECT_EQ(tiny_lfu.Estimate(key), estimate);
+  }
+
+  provider.Store();
+  EXPECT_GT(tiny_lfu.Estimate(key), estimate);
+}
+
+TEST_P(LargePageProviderTest, SwapStoresVictimPage) {
+  const auto dir_path = MakeEmptyDir("provider_swap");
+  TTinyLFU tiny_lfu;
+  LargePageProvider provider{dir_path, tiny_lfu, MakeConfig()};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // page 1 is the least frequent one, so it is the victim
+  const Key hot_key = KeyOfLargePage(0);
+  const Key victim_key = KeyOfLargePage(1);
+  provider.Get</*CalledOnUpdate=*/true>(hot_key)->Update(hot_key, far_future);
+  provider.Get</*CalledOnUpdate=*/true>(victim_key)
+      ->Update(victim_key, far_future);
+  for (size_t i = 0; i < LOADED_PAGE_NUMBER; ++i) {
+    if (i != 1) provider.Get</*CalledOnUpdate=*/false>(KeyOfLargePage(i));
+  }
+  provider.Get</*CalledOnUpdate=*/false>(hot_key);
+
+  const Key new_key = KeyOfLargePage(LOADED_PAGE_NUMBER);
+  LargePage* new_page = nullptr;
+  for (size_t i = 0; i <= FREQUENCY_THRESHOLD + 1 && new_page == nullptr;
+       ++i) {
+    new_page = provider.Get</*CalledOnUpdate=*/false>(new_key);
+  }
+
+  if (GetParam().async_swap) {
+    // the page is swapped in on the background
+    provider.WaitForPendingSwaps();
+    new_page = provider.Get</*CalledOnUpdate=*/false>(new_key);
+  }
+  ASSERT_NE(new_page, nullptr);
+  EXPECT_FALSE(new_page->Get(new_key, now));
+
+  EXPECT_EQ(provider.Get</*CalledOnUpdate=*/false>(victim_key), nullptr);
+  TLargePageStore store{dir_path};
+  auto victim_page = std::make_unique<LargePage>(tiny_lfu);
+  store.Load(/*page_index=*/1, *victim_page);
+  EXPECT_TRUE(victim_page->Get(victim_key, now));
+  EXPECT_TRUE(
+      provider.Get</*CalledOnUpdate=*/false>(hot_key)->Get(hot_key, now));
+}
+
+TEST(LargePageProvider, DestroyedDuringWarmUp) {
+  const auto dir_path = MakeEmptyDir("provider_warm_up");
+  const auto now = utils::Now();
+  StorePagesWithKeys(dir_path, now + 3600);
+
+  CacheConfig config;
+  config.lazy_load = true;
+  config.warm_up_lazy_pages = true;
+  for (size_t i = 0; i < 8; ++i) {
+    TTinyLFU tiny_lfu;
+    LargePageProvider provider{dir_path, tiny_lfu, config};
+    // races the warm-up for the slot of the page
+    const Key key = KeyOfLargePage(i, 1);
+    auto* page = provider.Get</*CalledOnUpdate=*/false>(key);
+    ASSERT_NE(page, nullptr);
+    EXPECT_TRUE(page->Get(key, now));
+  }
+}
+
+}  // namespace cache::test
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <cache.hpp>
+
+#include "test_utils.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace cache::test {
+
+template <class TStore>
+class LargePageStoreTest : public ::testing::Test {};
+
+using Stores = ::testing::Types<LargePageFileStore, LargePageMmapStore>;
+TYPED_TEST_SUITE(LargePageStoreTest, Stores);
+
+TYPED_TEST(LargePageStoreTest, LoadNeverStoredPage) {
+  TTinyLFU tiny_lfu;
+  auto large_page = std::make_unique<LargePage>(tiny_lfu);
+
+  const auto now = utils::Now();
+  large_page->Update(42, now + 3600);
+  EXPECT_TRUE(large_page->Get(42, now));
+
+  TypeParam store{MakeEmptyDir("large_page_store_test")};
+  store.Load(/*page_index=*/3, *large_page);
+  EXPECT_FALSE(large_page->Get(42, now));
+}
+
+TYPED_TEST(LargePageStoreTest, StoreLoad) {
+  TTinyLFU tiny_lfu;
+  auto large_page = std::make_unique<LargePage>(tiny_lfu);
+  auto other_page = std::make_unique<LargePage>(tiny_lfu);
+
+  std::random_device rd;
+  const auto seed = rd();
+  std::cout << "Seed: " << seed << std::endl;
+  std::mt19937 gen(seed);
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (size_t i = 0; i < 20'000; ++i) {
+    const uint32_t key = gen();
+    if (!large_page->Get(key, now)) large_page->Update(key, far_future);
+    other_page->Update(gen(), far_future);
+  }
+
+  const auto dir_path = MakeEmptyDir("large_page_store_test");
+  {
+    TypeParam store{dir_path};
+    store.Store(/*page_index=*/7, *large_page);
+    store.Store(/*page_index=*/8, *other_page);
+    store.Flush();
+  }
+
+  // reopen the store to check that the pages are persistent
+  TypeParam store{dir_path};
+  auto loaded_page = std::make_unique<LargePage>(tiny_lfu);
+  store.Load(/*page_index=*/7, *loaded_page);
+  EXPECT_TRUE(*loaded_page == *large_page);
+
+  store.Load(/*page_index=*/8, *loaded_page);
+  EXPECT_TRUE(*loaded_page == *other_page);
+}
+
+// A never stored page is cleared on the I/O worker (warm-up, async swap)
+// while the request thread resets the sketch shared with it: the clearing
+// must not read the sketch. The race is reported by ThreadSanitizer.
+TYPED_TEST(LargePageStoreTest, LoadOnWorkerWhileSketchResets) {
+  TTinyLFU tiny_lfu;
+  auto loaded_page = std::make_unique<LargePage>(tiny_lfu);
+  auto accessed_page = std::make_unique<LargePage>(tiny_lfu);
+  TypeParam store{MakeEmptyDir("large_page_store_test")};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  {
+    BackgroundWorker io_worker;
+    for (size_t i = 0; i < 64; ++i) {
+      io_worker.Push([&] { store.Load(/*page_index=*/1, *loaded_page); });
+    }
+    // every SAMPLE_SIZE additions reset the sketch
+    for (Key key = 0; key < 4 * SAMPLE_SIZE; ++key) {
+      if (!accessed_page->Get(key % 1024, now))
+        accessed_page->Update(key % 1024, far_future);
+    }
+    io_worker.Wait();
+  }
+  EXPECT_GT(tiny_lfu.GetResetCount(), 0);
+
+  loaded_page->Update(42, far_future);
+  EXPECT_TRUE(loaded_page->Get(42, now));
+}
+
+TEST(LargePageMmapStore, RejectsAnotherLayout) {
+  const auto dir_path = MakeEmptyDir("large_page_mmap_layout_test");
+  { LargePageMmapStore store{dir_path}; }
+
+  // 64-bit keys change the layout of the regions
+  using TStore64 = BasicLargePageMmapStore<BasicLargePage<uint64_t>>;
+  EXPECT_THROW(TStore64{dir_path}, std::invalid_argument);
+  EXPECT_NO_THROW(LargePageMmapStore{dir_path});
+}
+
+TEST(LargePageMmapStore, InitializesZeroHeader) {
+  const auto dir_path = MakeEmptyDir("large_page_mmap_zero_header_test");
+  { LargePageMmapStore store{dir_path}; }
+
+  // a crash after the file was resized and before the header was written
+  {
+    std::fstream file(dir_path / "pages.bin",
+                      std::ios_base::binary | std::ios_base::in |
+                          std::ios_base::out);
+    const std::vector<char> zeros(64, 0);
+    file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+  }
+
+  TTinyLFU tiny_lfu;
+  auto page = std::make_unique<LargePage>(tiny_lfu);
+  const auto now = utils::Now();
+  page->Update(42, now + 3600);
+  {
+    LargePageMmapStore store{dir_path};
+    store.Store(/*page_index=*/1, *page);
+    store.Flush();
+  }
+
+  LargePageMmapStore store{dir_path};
+  auto loaded_page = std::make_unique<LargePage>(tiny_lfu);
+  store.Load(/*page_index=*/1, *loaded_page);
+  EXPECT_TRUE(loaded_page->Get(42, now));
+}
+
+}  // namespace cache::test
@@ -78,4 +78,85 @@ TEST(LRU, MaxSizeGreaterThanZeroNoTTL) {
   EXPECT_TRUE(lru.Get(2, now));
 }
 
+TEST(LRU, ExpiredNodesReused) {
+  LRU<uint32_t> lru{3};
+
+  const auto now = utils::Now();
+  const auto future = now + 3600;
+
+  EXPECT_FALSE(lru.Update(1, future).has_value());
+  EXPECT_FALSE(lru.Update(2, future).has_value());
+  EXPECT_FALSE(lru.Update(3, now).has_value());
+  EXPECT_FALSE(lru.Get(3, now + 60));  // frees the node of 3
+  EXPECT_FALSE(lru.Get(2, future + 60));
+
+  // the freed nodes are taken before anything is evicted
+  EXPECT_FALSE(lru.Update(4, future).has_value());
+  EXPECT_FALSE(lru.Update(5, future).has_value());
+  EXPECT_TRUE(lru.Get(1, now));
+  EXPECT_TRUE(lru.Get(4, now));
+  EXPECT_TRUE(lru.Get(5, now));
+
+  auto evicted = lru.Update(6, future);
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(*evicted, 1);
+  EXPECT_TRUE(lru.Get(6, now));
+}
+
+TEST(LRU, SetMaxSize) {
+  LRU<uint32_t> lru{4};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  for (uint32_t key = 1; key <= 4; ++key) lru.Update(key, far_future);
+  EXPECT_TRUE(lru.Get(1, now));
+
+  // the least recently used entries go first
+  lru.SetMaxSize(2);
+  EXPECT_EQ(lru.MaxSize(), 2);
+  auto evicted = lru.EvictExcess();
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->key, 2);
+  evicted = lru.EvictExcess();
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->key, 3);
+  EXPECT_FALSE(lru.EvictExcess().has_value());
+
+  auto evicted_key = lru.Update(5, far_future);
+  ASSERT_TRUE(evicted_key.has_value());
+  EXPECT_EQ(*evicted_key, 4);
+
+  // a grown LRU takes the new keys up to its capacity
+  lru.SetMaxSize(4);
+  EXPECT_FALSE(lru.Update(6, far_future).has_value());
+  EXPECT_FALSE(lru.Update(7, far_future).has_value());
+  EXPECT_FALSE(lru.EvictExcess().has_value());
+  evicted_key = lru.Update(8, far_future);
+  ASSERT_TRUE(evicted_key.has_value());
+  EXPECT_EQ(*evicted_key, 1);
+}
+
+TEST(LRU, ValuesNoTTL) {
+  LRU<uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>, std::string>
+      lru{2};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  EXPECT_FALSE(lru.UpdateEntry(1, far_future, "a").has_value());
+  EXPECT_FALSE(lru.UpdateEntry(2, far_future, "b").has_value());
+  EXPECT_FALSE(lru.UpdateEntry(1, far_future + 1, "c").has_value());
+
+  std::string value;
+  EXPECT_TRUE(lru.Get(1, now, &value));
+  EXPECT_EQ(value, "c");
+
+  auto evicted = lru.UpdateEntry(3, far_future, "d");
+  ASSERT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->key, 2);
+  EXPECT_EQ(evicted->expiration_time, far_future);
+  EXPECT_EQ(evicted->value, "b");
+}
+
 }  // namespace cache::test
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <sharded_cache.hpp>
+
+#include "test_utils.hpp"
+
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace cache::test {
+
+TEST(ShardedCache, BasicsNoTTL) {
+  ShardedCache cache{/*num_shards=*/4, MakeEmptyDir("sharded_cache_basics")};
+  EXPECT_EQ(cache.GetShardsNumber(), 4);
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // the LOADED_PAGE_NUMBER first pages are loaded, split across the shards
+  for (size_t page = 0; page < LOADED_PAGE_NUMBER; ++page) {
+    for (Key offset = 0; offset < 10; ++offset) {
+      const Key key = KeyOfLargePage(page, offset);
+      EXPECT_FALSE(cache.Get(key, now));
+      cache.Update(key, far_future);
+      EXPECT_TRUE(cache.Get(key, now));
+    }
+  }
+}
+
+TEST(ShardedCache, SplitsBudget) {
+  const auto dir_path = MakeEmptyDir("sharded_cache_budget");
+  CacheConfig config;
+  config.use_lru = false;
+  config.loaded_page_number = 6;
+  ShardedCache cache{/*num_shards=*/4, dir_path, config};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  // the shards 0 and 1 load 2 pages, the shards 2 and 3 a single one
+  for (size_t page = 0; page < 8; ++page) {
+    const Key key = KeyOfLargePage(page, 1);
+    cache.Update(key, far_future);
+    EXPECT_EQ(cache.Get(key, now), page < config.loaded_page_number);
+  }
+
+  EXPECT_THROW((ShardedCache{/*num_shards=*/0, dir_path, config}),
+               std::invalid_argument);
+  EXPECT_THROW((ShardedCache{/*num_shards=*/7, dir_path, config}),
+               std::invalid_argument);
+}
+
+// The param is `CacheConfig::async_swap`
+class ShardedCacheTest : public ::testing::TestWithParam<bool> {};
+
+INSTANTIATE_TEST_SUITE_P(SwapModes, ShardedCacheTest, ::testing::Bool(),
+                         [](const auto& info) {
+                           return info.param ? "AsyncSwap" : "SyncSwap";
+                         });
+
+TEST_P(ShardedCacheTest, ConcurrentGetUpdate) {
+  const size_t kNumThreads = 4;
+  // few loaded pages and a low threshold: the shards keep swapping
+  CacheConfig config;
+  config.async_swap = GetParam();
+  config.loaded_page_number = 2 * kNumThreads;
+  config.frequency_threshold = 10;
+  ShardedCache cache{/*num_shards=*/kNumThreads,
+                     MakeEmptyDir("sharded_cache_concurrent"), config};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+
+  std::vector<std::thread> threads;
+  std::vector<size_t> hits(kNumThreads, 0);
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&cache, &hits, i, now, far_future] {
+      std::mt19937 gen(i);
+      for (size_t op = 0; op < 20'000; ++op) {
+        const Key key = KeyOfLargePage(gen() % LOADED_PAGE_NUMBER, gen() % 500);
+        if (cache.Get(key, now)) {
+          ++hits[i];
+        } else {
+          cache.Update(key, far_future);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (auto thread_hits : hits) EXPECT_GT(thread_hits, 0);
+  cache.Store();
+}
+
+}  // namespace cache::test
@@ -3,6 +3,7 @@
 #include <cache.hpp>
 
 #include <chrono>
+#include <vector>
 
 namespace cache::test {
 
@@ -42,4 +43,325 @@ TEST(SmallPageTLFU, BasicsWithTTL) {
   }
 }
 
+TEST(SmallPageTLFU, CachedFrequenciesAgedOnReset) {
+  TTinyLFU tiny_lfu;
+  SmallPageAdvanced small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_TRUE(small_page.Update(i, far_future));
+  }
+
+  // the cached estimations of the records are aged to zero as the sketch
+  for (size_t i = 0; i < 4; ++i) tiny_lfu.Reset();
+
+  const Key new_key = SMALL_PAGE_SIZE;
+  tiny_lfu.Add(new_key);
+  EXPECT_TRUE(small_page.Update(new_key, far_future));
+  EXPECT_TRUE(small_page.Get(new_key, now));
+}
+
+using SampledVictimSmallPage =
+    BasicSmallPage<Key, NoValues, SmallPageOrdering::kSampledVictim>;
+
+TEST(SmallPageSampledVictim, BasicsWithTTL) {
+  TTinyLFU tiny_lfu;
+  SampledVictimSmallPage small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto future = now + 3600;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_FALSE(small_page.Get(i, now));
+    EXPECT_TRUE(small_page.Update(i, i % 2 ? future : future + 2 * 3600));
+    EXPECT_TRUE(small_page.Get(i, now));
+  }
+
+  // expired records are removed, the rest are still found
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; i += 2) {
+    EXPECT_FALSE(small_page.Get(i + 1, future + 60));
+  }
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; i += 2) {
+    EXPECT_TRUE(small_page.Get(i, future + 60));
+  }
+
+  // the page has free slots again
+  for (size_t i = 0; i < SMALL_PAGE_SIZE / 2; ++i) {
+    EXPECT_TRUE(small_page.Update(SMALL_PAGE_SIZE + i, future));
+  }
+}
+
+TEST(SmallPageSampledVictim, EvictsColdKey) {
+  TTinyLFU tiny_lfu;
+  SampledVictimSmallPage small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_TRUE(small_page.Update(i, far_future));
+  }
+  // even keys are hot
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; i += 2) {
+    for (size_t j = 0; j < 6; ++j) small_page.Get(i, now);
+  }
+
+  // more frequent than the cold keys, less frequent than the hot ones
+  const Key new_key = SMALL_PAGE_SIZE;
+  for (size_t j = 0; j < 3; ++j) tiny_lfu.Add(new_key);
+  EXPECT_TRUE(small_page.Update(new_key, far_future));
+  EXPECT_TRUE(small_page.Get(new_key, now));
+
+  size_t cold_keys = 0;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_TRUE(small_page.Get(i, now));
+    } else {
+      cold_keys += small_page.Get(i, now);
+    }
+  }
+  EXPECT_EQ(cold_keys, SMALL_PAGE_SIZE / 2 - 1);
+}
+
+using HashedSmallPage =
+    BasicSmallPage<Key, NoValues, SmallPageOrdering::kHashed>;
+
+TEST(SmallPageHashed, BasicsWithTTL) {
+  TTinyLFU tiny_lfu;
+  HashedSmallPage small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto future = now + 3600;
+  // the buckets are filled unevenly, a key of a full bucket isn't admitted
+  std::vector<Key> cached;
+  for (Key i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_FALSE(small_page.Get(i, now));
+    if (small_page.Update(i, i % 2 ? future : future + 2 * 3600)) {
+      cached.push_back(i);
+      EXPECT_TRUE(small_page.Get(i, now));
+    } else {
+      EXPECT_FALSE(small_page.Get(i, now));
+    }
+  }
+  EXPECT_GT(cached.size(), SMALL_PAGE_SIZE / 2);
+
+  // expired records are removed, the rest are still found
+  for (auto key : cached) {
+    if (key % 2) {
+      EXPECT_FALSE(small_page.Get(key, future + 60));
+    }
+  }
+  for (auto key : cached) {
+    if (key % 2 == 0) {
+      EXPECT_TRUE(small_page.Get(key, future + 60));
+    }
+  }
+
+  // the slots of the expired keys are free again
+  for (auto key : cached) {
+    if (key % 2) {
+      EXPECT_TRUE(small_page.Update(key, future));
+    }
+  }
+}
+
+TEST(SmallPageHashed, EvictsColdKeyOfBucket) {
+  TTinyLFU tiny_lfu;
+  HashedSmallPage small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  // every bucket is full
+  for (Key i = 1; i <= 4 * SMALL_PAGE_SIZE; ++i) {
+    small_page.Update(i, far_future);
+  }
+  std::vector<Key> cached;
+  for (Key i = 1; i <= 4 * SMALL_PAGE_SIZE; ++i) {
+    if (small_page.Get(i, now)) cached.push_back(i);
+  }
+  EXPECT_EQ(cached.size(), SMALL_PAGE_SIZE);
+
+  const Key new_key = 0;
+  EXPECT_FALSE(small_page.Update(new_key, far_future));
+
+  // a half of the keys are hot
+  for (size_t i = 0; i < cached.size(); i += 2) {
+    for (size_t j = 0; j < 6; ++j) small_page.Get(cached[i], now);
+  }
+
+  // more frequent than the cold keys, less frequent than the hot ones
+  for (size_t j = 0; j < 3; ++j) tiny_lfu.Add(new_key);
+  EXPECT_TRUE(small_page.Update(new_key, far_future));
+  EXPECT_TRUE(small_page.Get(new_key, now));
+
+  size_t cold_keys = 0;
+  for (size_t i = 0; i < cached.size(); ++i) {
+    if (i % 2 == 0) {
+      EXPECT_TRUE(small_page.Get(cached[i], now));
+    } else {
+      cold_keys += small_page.Get(cached[i], now);
+    }
+  }
+  EXPECT_EQ(cold_keys, SMALL_PAGE_SIZE / 2 - 1);
+}
+
+// The hits buffered by a page are applied before it's modified
+TEST(SmallPageTLFU, BufferedHitsAppliedOnUpdate) {
+  static_assert(SMALL_PAGE_READ_BUFFER_SIZE > 4);
+  TTinyLFU tiny_lfu;
+  SmallPageAdvanced small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (Key i = 1; i <= SMALL_PAGE_SIZE; ++i) {
+    EXPECT_TRUE(small_page.Update(i, far_future));
+  }
+
+  // the last record is the victim until its hits are applied
+  const Key hot_key = SMALL_PAGE_SIZE;
+  for (size_t j = 0; j < 4; ++j) EXPECT_TRUE(small_page.Get(hot_key, now));
+
+  const Key new_key = 0;
+  for (size_t j = 0; j < 3; ++j) tiny_lfu.Add(new_key);
+  EXPECT_TRUE(small_page.Update(new_key, far_future));
+  EXPECT_TRUE(small_page.Get(hot_key, now));
+  EXPECT_TRUE(small_page.Get(new_key, now));
+}
+
+TEST(SmallPageTLFU, BufferedHitsAndExpiredRecords) {
+  TTinyLFU tiny_lfu;
+  SmallPageAdvanced small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto future = now + 3600;
+  for (Key i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_TRUE(small_page.Update(i, i % 2 ? future : future + 2 * 3600));
+  }
+
+  // the hits of the last records raise them over the expired ones
+  for (Key i = SMALL_PAGE_SIZE; i-- > 0;) {
+    EXPECT_EQ(small_page.Get(i, future + 60), i % 2 == 0);
+  }
+  for (Key i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_EQ(small_page.Get(i, future + 60), i % 2 == 0);
+  }
+}
+
+TEST(SmallPageTLFU, KeysDifferInHighBits64) {
+  TBasicTinyLFU<uint64_t> tiny_lfu;
+  BasicSmallPage<uint64_t> small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  constexpr uint64_t kHighBit = 1ull << 40;
+  for (uint64_t i = 0; i < SMALL_PAGE_SIZE / 2; ++i) {
+    EXPECT_TRUE(small_page.Update(i, far_future));
+  }
+  for (uint64_t i = 0; i < SMALL_PAGE_SIZE / 2; ++i) {
+    EXPECT_TRUE(small_page.Get(i, now));
+    EXPECT_FALSE(small_page.Get(i | kHighBit, now));
+  }
+}
+
+TEST(SmallPageFind, SIMD64) {
+  if (kSimdLevel < SimdLevel::kAVX2) GTEST_SKIP() << "AVX2 isn't supported";
+  alignas(32) std::array<uint64_t, SMALL_PAGE_SIZE> records{};
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    records[i] = (uint64_t{i} << 32) | 7;
+  }
+
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_EQ(FindKeyIdxSIMD16(records[i], records), i);
+    EXPECT_EQ(FindKeyIdx(records[i], records), i);
+  }
+  EXPECT_EQ(FindKeyIdxSIMD16(uint64_t{8}, records), SMALL_PAGE_SIZE);
+}
+
+template <CacheKey TKey>
+void CheckFindKernels() {
+  alignas(64) std::array<TKey, SMALL_PAGE_SIZE> records{};
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    records[i] = static_cast<TKey>((i << 16) | 7);
+  }
+
+  // only the kernels supported by the CPU are checked
+  for (auto level : {SimdLevel::kScalar, SimdLevel::kSSE42, SimdLevel::kAVX2,
+                     SimdLevel::kAVX512}) {
+    if (level > kSimdLevel) break;
+    const auto find = SelectFindKeyIdx<TKey>(level);
+    for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+      EXPECT_EQ(find(records[i], records), i) << ToString(level);
+    }
+    EXPECT_EQ(find(TKey{8}, records), SMALL_PAGE_SIZE) << ToString(level);
+  }
+  EXPECT_EQ(FindKeyIdxDispatched(records[42], records), 42);
+
+  constexpr size_t kBucketSize = SMALL_PAGE_BUCKET_SIZE;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    const auto* bucket = &records[i / kBucketSize * kBucketSize];
+    EXPECT_EQ(FindKeyIdxInBucket<kBucketSize>(records[i], bucket),
+              i % kBucketSize);
+    EXPECT_EQ(FindKeyIdxInBucket<kBucketSize>(TKey{8}, bucket), kBucketSize);
+  }
+}
+
+TEST(SmallPageFind, AllKernels) {
+  CheckFindKernels<Key>();
+  CheckFindKernels<uint64_t>();
+}
+
+TEST(SmallPageTLFU, FixedValues) {
+  TTinyLFU tiny_lfu;
+  using TSmallPage = BasicSmallPage<Key, FixedValues<uint64_t>>;
+  auto small_page = std::make_unique<TSmallPage>(tiny_lfu);
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  for (size_t i = 0; i < SMALL_PAGE_SIZE; ++i) {
+    EXPECT_TRUE(small_page->Update(i, far_future, i * i));
+  }
+
+  // keys are moved between the slots by the frequency
+  for (size_t i = SMALL_PAGE_SIZE; i-- > 0;) {
+    uint64_t value = 0;
+    EXPECT_TRUE(small_page->Get(i, now, &value));
+    EXPECT_EQ(value, i * i);
+  }
+
+  EXPECT_TRUE(small_page->Update(1, far_future, 42));
+  uint64_t value = 0;
+  EXPECT_TRUE(small_page->Get(1, now, &value));
+  EXPECT_EQ(value, 42);
+}
+
+TEST(SmallPageTLFU, SlabValues) {
+  constexpr size_t kSlabSize = 64;
+  TTinyLFU tiny_lfu;
+  BasicSmallPage<Key, SlabValues<kSlabSize>> small_page{tiny_lfu};
+
+  const auto now = utils::Now();
+  const auto far_future = now + 3600;
+  const std::string value(kSlabSize / 2, 'a');
+  EXPECT_TRUE(small_page.Update(1, far_future, value));
+  EXPECT_TRUE(small_page.Update(2, far_future, value));
+  // the slab is full
+  EXPECT_FALSE(small_page.Update(3, far_future, "b"));
+  EXPECT_FALSE(small_page.Get(3, now));
+
+  // the space of the overwritten value is reclaimed
+  EXPECT_TRUE(small_page.Update(1, far_future, "c"));
+  EXPECT_TRUE(small_page.Update(3, far_future, "b"));
+
+  std::string out;
+  EXPECT_TRUE(small_page.Get(1, now, &out));
+  EXPECT_EQ(out, "c");
+  EXPECT_TRUE(small_page.Get(2, now, &out));
+  EXPECT_EQ(out, value);
+  EXPECT_TRUE(small_page.Get(3, now, &out));
+  EXPECT_EQ(out, "b");
+
+  // a value which doesn't fit removes the key
+  EXPECT_FALSE(small_page.Update(2, far_future, std::string(kSlabSize, 'd')));
+  EXPECT_FALSE(small_page.Get(2, now));
+}
+
 }  // namespace cache::test
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cache_config.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+namespace cache::test {
+
+// A fresh directory `name` in the temp directory, removed if it exists
+inline std::filesystem::path MakeEmptyDir(const std::string& name) {
+  auto dir_path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir_path);
+  return dir_path;
+}
+
+// The key `offset` of the large page `page_index`
+inline Key KeyOfLargePage(size_t page_index, Key offset = 0) {
+  return static_cast<Key>(page_index << (8 * sizeof(Key) - LARGE_PAGE_SHIFT)) +
+         offset;
+}
+
+}  // namespace cache::test
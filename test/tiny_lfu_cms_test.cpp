@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <random>
+#include <thread>
+#include <vector>
+
 #include <tiny_lfu_cms.hpp>
 
 namespace cache::test {
@@ -116,4 +120,161 @@ TEST(TinyLFUBasedOnCMS, SerializeDeserialize) {
   }
 }
 
+// Every SampleSize / AgingSlices additions a slice of the sketch is halved
+TEST(TinyLFUBasedOnCMS, IncrementalAging) {
+  constexpr size_t kSampleSize = 400;
+  TinyLFU<uint32_t, kSampleSize, /*NumCounters=*/1024, /*UseDoorKeeper=*/false,
+          CountMinSketch<1024>, /*AgingSlices=*/4>
+      tiny_lfu;
+  TinyLFU<uint32_t, kSampleSize, /*NumCounters=*/1024, /*UseDoorKeeper=*/true,
+          BlockedCountMinSketch<1024>, /*AgingSlices=*/4>
+      tiny_lfu_dk;
+
+  for (size_t i = 0; i < 15; ++i) {
+    tiny_lfu.Add(5);
+    tiny_lfu_dk.Add(5);
+  }
+  for (uint32_t key = 1000; key < 1000 + kSampleSize - 16; ++key) {
+    tiny_lfu.Add(key);
+    tiny_lfu_dk.Add(key);
+  }
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 0);
+  EXPECT_EQ(tiny_lfu_dk.GetResetCount(), 0);
+
+  tiny_lfu.Add(1);
+  tiny_lfu_dk.Add(1);
+  // all the slices are halved once
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 1);
+  EXPECT_EQ(tiny_lfu_dk.GetResetCount(), 1);
+  EXPECT_EQ(tiny_lfu.Estimate(5), 7);
+  // the door keeper is cleared
+  EXPECT_EQ(tiny_lfu_dk.Estimate(5), 7);
+
+  {
+    std::ofstream file("/tmp/tiny_lfu_aging.bin", std::ios::binary);
+    tiny_lfu_dk.Store(file);
+  }
+  decltype(tiny_lfu_dk) loaded;
+  {
+    std::ifstream file("/tmp/tiny_lfu_aging.bin", std::ios::binary);
+    loaded.Load(file);
+  }
+  EXPECT_TRUE(loaded == tiny_lfu_dk);
+}
+
+TEST(ConcurrentTinyLFU, Basics) {
+  const size_t sample_size = 4;
+  ConcurrentTinyLFU<uint32_t, sample_size, /*NumCounters=*/4> tiny_lfu;
+
+  for (size_t i = 1; i < sample_size; ++i) {
+    tiny_lfu.Add(1);
+    EXPECT_EQ(tiny_lfu.Estimate(1), i);
+  }
+
+  tiny_lfu.Add(1);
+  EXPECT_EQ(tiny_lfu.Estimate(1), 2);
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 1);
+
+  tiny_lfu.Clear();
+  EXPECT_EQ(tiny_lfu.Estimate(1), 0);
+}
+
+TEST(ConcurrentTinyLFU, ConcurrentAdds) {
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kAddsPerKey = 10;
+  constexpr uint32_t kKeysPerThread = 100;
+  // no aging: no addition may be lost
+  ConcurrentTinyLFU<uint32_t, /*SampleSize=*/0, /*NumCounters=*/1 << 16>
+      tiny_lfu;
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&tiny_lfu] {
+      // all the threads add the same keys
+      for (size_t i = 0; i < kAddsPerKey; ++i) {
+        for (uint32_t key = 0; key < kKeysPerThread; ++key) tiny_lfu.Add(key);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (uint32_t key = 0; key < kKeysPerThread; ++key) {
+    EXPECT_EQ(tiny_lfu.Estimate(key), 15);
+  }
+  EXPECT_EQ(tiny_lfu.Estimate(kKeysPerThread), 0);
+}
+
+TEST(ConcurrentTinyLFU, ConcurrentAging) {
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kSampleSize = 1000;
+  ConcurrentTinyLFU<uint32_t, kSampleSize, /*NumCounters=*/1024,
+                    /*AgingSlices=*/4>
+      tiny_lfu;
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&tiny_lfu, t] {
+      std::mt19937 gen(t);
+      for (size_t i = 0; i < 10 * kSampleSize; ++i) {
+        tiny_lfu.Add(gen() % 100);
+        EXPECT_LE(tiny_lfu.Estimate(gen() % 100), 15);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  // a round of slices is 1000 additions, some may be lost for the sample
+  EXPECT_GE(tiny_lfu.GetResetCount(), 30);
+  EXPECT_LE(tiny_lfu.GetResetCount(), 40);
+}
+
+TEST(ConcurrentTinyLFU, AgesCounterPastPeriod) {
+  // the counter of a sketch with a longer period is past the period
+  ConcurrentTinyLFU<uint32_t, /*SampleSize=*/1000, /*NumCounters=*/1024>
+      long_period;
+  for (size_t i = 0; i < 500; ++i) long_period.Add(1);
+  {
+    std::ofstream file("/tmp/concurrent_tiny_lfu_period.bin",
+                       std::ios::binary);
+    long_period.Store(file);
+  }
+
+  ConcurrentTinyLFU<uint32_t, /*SampleSize=*/100, /*NumCounters=*/1024>
+      tiny_lfu;
+  {
+    std::ifstream file("/tmp/concurrent_tiny_lfu_period.bin",
+                       std::ios::binary);
+    tiny_lfu.Load(file);
+  }
+  EXPECT_EQ(tiny_lfu.Estimate(1), 15);
+
+  tiny_lfu.Add(2);
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 1);
+  EXPECT_EQ(tiny_lfu.Estimate(1), 7);
+  // the next period is a full one
+  for (size_t i = 0; i < 99; ++i) tiny_lfu.Add(2);
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 1);
+  tiny_lfu.Add(2);
+  EXPECT_EQ(tiny_lfu.GetResetCount(), 2);
+}
+
+TEST(ConcurrentTinyLFU, SerializeDeserialize) {
+  using TLFU = ConcurrentTinyLFU<uint32_t, /*SampleSize=*/1000,
+                                 /*NumCounters=*/1024, /*AgingSlices=*/4>;
+  TLFU tiny_lfu;
+  std::mt19937 gen(42);
+  for (size_t i = 0; i < 1500; ++i) tiny_lfu.Add(gen() % 100);
+
+  {
+    std::ofstream file("/tmp/concurrent_tiny_lfu.bin", std::ios::binary);
+    tiny_lfu.Store(file);
+  }
+  TLFU loaded;
+  {
+    std::ifstream file("/tmp/concurrent_tiny_lfu.bin", std::ios::binary);
+    loaded.Load(file);
+  }
+  EXPECT_TRUE(loaded == tiny_lfu);
+}
+
 }  // namespace cache::test